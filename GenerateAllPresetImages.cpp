@@ -1,150 +1,319 @@
 #include <juce_graphics/juce_graphics.h>
 #include <juce_core/juce_core.h>
 #include <iostream>
+#include "GlowBlur.h"
+#include "Source/ProceduralGlow.h"
 
-juce::Image createBlurredGradient(int size, const juce::Colour& color, int blurRadius)
+// Alpha multipliers along the radius, between the solid centre and the clear edge
+struct GradientStop
+{
+    double position;
+    float alpha;
+};
+
+static const GradientStop gradientStops[] = {
+    {0.3, 0.9f},
+    {0.5, 0.6f},
+    {0.7, 0.3f},
+    {0.9, 0.1f}
+};
+
+// Bump when the rendering itself changes, so every layer gets regenerated
+static const int generatorVersion = 2;
+
+juce::Image createBlurredGradient(int size, const juce::Colour& color, int blurRadius, int blurThreads = 0)
 {
     int imageSize = size + blurRadius * 2;
     juce::Image img(juce::Image::ARGB, imageSize, imageSize, true);
 
-    juce::Graphics g(img);
+    {
+        juce::Graphics g(img);
 
-    float centerX = imageSize / 2.0f;
-    float centerY = imageSize / 2.0f;
-    float radius = size / 2.0f;
+        float centerX = imageSize / 2.0f;
+        float centerY = imageSize / 2.0f;
+        float radius = size / 2.0f;
 
-    juce::ColourGradient gradient(
-        color,
-        centerX, centerY,
-        color.withAlpha(0.0f),
-        centerX + radius, centerY,
-        true
-    );
+        juce::ColourGradient gradient(
+            color,
+            centerX, centerY,
+            color.withAlpha(0.0f),
+            centerX + radius, centerY,
+            true
+        );
 
-    gradient.addColour(0.3, color.withMultipliedAlpha(0.9f));
-    gradient.addColour(0.5, color.withMultipliedAlpha(0.6f));
-    gradient.addColour(0.7, color.withMultipliedAlpha(0.3f));
-    gradient.addColour(0.9, color.withMultipliedAlpha(0.1f));
+        for (auto& stop : gradientStops)
+            gradient.addColour(stop.position, color.withMultipliedAlpha(stop.alpha));
 
-    g.setGradientFill(gradient);
-    g.fillEllipse(centerX - radius, centerY - radius, radius * 2, radius * 2);
+        g.setGradientFill(gradient);
+        g.fillEllipse(centerX - radius, centerY - radius, radius * 2, radius * 2);
+    }
 
     if (blurRadius > 0)
     {
-        juce::ImageConvolutionKernel blur(blurRadius);
-        blur.createGaussianBlur(blurRadius * 0.4f);
-        blur.applyToImage(img, img, juce::Rectangle<int>(0, 0, imageSize, imageSize));
+        // Same kernel as juce::ImageConvolutionKernel(blurRadius).createGaussianBlur(),
+        // applied as two separable passes
+        GlowBlur::applyGaussianBlur(img, blurRadius, blurRadius * 0.4f, blurThreads);
     }
 
     return img;
 }
 
-int main(int argc, char* argv[])
+struct LayerJob
 {
-    juce::initialiseJuce_GUI();
+    juce::String filename;
+    int size;
+    float alpha;
+    int blurRadius;
+    juce::String hash;
 
-    std::cout << "Generating glow images for all 3 presets...\n\n";
+    // Filled in by the worker
+    bool queued = false;
+    bool written = false;
+    bool failed = false;
+    juce::uint32 elapsedMs = 0;
+};
 
-    struct PresetConfig {
-        const char* name;
-        juce::Colour colors[5];
-        int sizes[5];
-    };
+// Everything that affects a layer's pixels goes into its hash
+static juce::String hashLayerParameters(int size, float alpha, int blurRadius)
+{
+    juce::String description;
+    description << "v" << generatorVersion
+                << "|size=" << size
+                << "|alpha=" << juce::String(alpha, 4)
+                << "|blur=" << blurRadius
+                << "|sigma=" << juce::String(blurRadius * 0.4f, 4)
+                << "|stops=";
+
+    for (auto& stop : gradientStops)
+        description << juce::String(stop.position, 3) << ":" << juce::String(stop.alpha, 3) << ",";
+
+    return juce::String::toHexString(description.hashCode64());
+}
+
+static void renderLayer(LayerJob& job, const juce::File& outputFile)
+{
+    auto start = juce::Time::getMillisecondCounter();
+
+    // The pool already runs one layer per core, so each blur stays single-threaded
+    juce::Image img = createBlurredGradient(job.size, juce::Colours::white.withAlpha(job.alpha), job.blurRadius, 1);
+
+    juce::MemoryOutputStream png;
+    juce::PNGImageFormat pngFormat;
+
+    if (!pngFormat.writeImageToStream(img, png))
+    {
+        job.failed = true;
+        return;
+    }
+
+    // Don't touch the file if the bytes are the same - CMake would rebuild GlowResources
+    juce::MemoryBlock existing;
+    if (!(outputFile.loadFileAsData(existing) && existing == png.getMemoryBlock()))
+    {
+        job.failed = !outputFile.replaceWithData(png.getData(), png.getDataSize());
+        job.written = !job.failed;
+    }
+
+    job.elapsedMs = juce::Time::getMillisecondCounter() - start;
+}
 
-    // Standard sizes for blue and red presets
-    int sizes[] = {120, 180, 260, 360, 480};
-    
-    // Smaller sizes for black preset (white glow needs to be smaller for visual balance)
-    int blackPresetSizes[] = {100, 150, 215, 300, 400};
+// Compares what the plugin renders at runtime with the masks on disk.
+// Returns false if any layer is missing or off by more than the tolerance.
+static bool checkProceduralParity(const std::vector<LayerJob>& jobs, const juce::File& resourcesDir)
+{
+    // The masks went through 8-bit quantisation and a slightly different
+    // blur edge, so allow a few levels of difference
+    const int maxErrorTolerance = 8;
+    const double meanErrorTolerance = 1.5;
+    bool allPassed = true;
+
+    for (auto& job : jobs)
+    {
+        std::cout << "  " << job.filename << ": ";
 
-    PresetConfig presets[] = {
-        // Blue preset
+        auto reference = juce::ImageFileFormat::loadFrom(resourcesDir.getChildFile(job.filename));
+        if (!reference.isValid())
         {
-            "blue",
-            {
-                juce::Colour::fromFloatRGBA(0.0f, 0.55f, 1.0f, 0.95f),
-                juce::Colour::fromFloatRGBA(0.0f, 0.57f, 1.0f, 0.75f),
-                juce::Colour::fromFloatRGBA(0.04f, 0.59f, 1.0f, 0.60f),
-                juce::Colour::fromFloatRGBA(0.12f, 0.63f, 1.0f, 0.45f),
-                juce::Colour::fromFloatRGBA(0.20f, 0.69f, 1.0f, 0.35f)
-            },
-            {}  // Will be filled below
-        },
-        // Red preset
+            std::cout << "MISSING\n";
+            allPassed = false;
+            continue;
+        }
+
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        auto rendered = ProceduralGlow::renderMask({ job.size, job.alpha, job.blurRadius });
+        auto elapsedMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        if (rendered.getWidth() != reference.getWidth() || rendered.getHeight() != reference.getHeight())
         {
-            "red",
-            {
-                juce::Colour::fromFloatRGBA(1.0f, 0.27f, 0.23f, 0.95f),
-                juce::Colour::fromFloatRGBA(1.0f, 0.29f, 0.25f, 0.75f),
-                juce::Colour::fromFloatRGBA(1.0f, 0.33f, 0.29f, 0.60f),
-                juce::Colour::fromFloatRGBA(1.0f, 0.39f, 0.35f, 0.45f),
-                juce::Colour::fromFloatRGBA(1.0f, 0.47f, 0.43f, 0.35f)
-            },
-            {}  // Will be filled below
-        },
-        // Black preset (white glow)
+            std::cout << "size mismatch (" << rendered.getWidth() << " vs " << reference.getWidth() << ")\n";
+            allPassed = false;
+            continue;
+        }
+
+        juce::Image::BitmapData renderedData(rendered, juce::Image::BitmapData::readOnly);
+        int maxError = 0;
+        double totalError = 0.0;
+
+        for (int y = 0; y < reference.getHeight(); ++y)
         {
-            "black",
+            for (int x = 0; x < reference.getWidth(); ++x)
             {
-                juce::Colour::fromFloatRGBA(1.0f, 1.0f, 1.0f, 0.95f),
-                juce::Colour::fromFloatRGBA(1.0f, 1.0f, 1.0f, 0.75f),
-                juce::Colour::fromFloatRGBA(1.0f, 1.0f, 1.0f, 0.60f),
-                juce::Colour::fromFloatRGBA(1.0f, 1.0f, 1.0f, 0.45f),
-                juce::Colour::fromFloatRGBA(1.0f, 1.0f, 1.0f, 0.35f)
-            },
-            {}  // Will be filled below
+                int error = std::abs((int)reference.getPixelAt(x, y).getAlpha() - (int)*renderedData.getPixelPointer(x, y));
+                maxError = juce::jmax(maxError, error);
+                totalError += error;
+            }
         }
-    };
 
-    // Fill in sizes for each preset
-    for (int p = 0; p < 3; ++p) {
-        int* currentSizes = (p == 2) ? blackPresetSizes : sizes;  // Use smaller sizes for black preset
-        for (int i = 0; i < 5; ++i) {
-            presets[p].sizes[i] = currentSizes[i];
-        }
+        double meanError = totalError / (reference.getWidth() * reference.getHeight());
+        bool passed = maxError <= maxErrorTolerance && meanError <= meanErrorTolerance;
+        allPassed = allPassed && passed;
+
+        std::cout << (passed ? "ok" : "FAILED") << " (max " << maxError << ", mean "
+                  << juce::String(meanError, 3) << ", rendered in " << juce::String(elapsedMs, 1) << "ms)\n";
     }
 
+    return allPassed;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::initialiseJuce_GUI();
+
+    bool force = false;
+    bool checkProcedural = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (juce::String(argv[i]) == "--force")
+            force = true;
+        else if (juce::String(argv[i]) == "--check-procedural")
+            checkProcedural = true;
+    }
+
+    // Masks are white; the colour is applied when the XY control draws them.
+    // Blue and red share the standard sizes, black uses the compact ones.
+    struct MaskSetConfig {
+        const char* name;
+        int sizes[5];
+    };
+
+    MaskSetConfig maskSets[] = {
+        // Standard sizes for blue and red presets
+        { "standard", {120, 180, 260, 360, 480} },
+        // Smaller sizes for black preset (white glow needs to be smaller for visual balance)
+        { "compact",  {100, 150, 215, 300, 400} }
+    };
+
+    // Per-layer opacity is baked into the mask alpha.
+    // ProceduralGlow::getLayerSpec() has the same table - keep them in sync.
+    float layerAlphas[] = {0.95f, 0.75f, 0.60f, 0.45f, 0.35f};
+
+    int blurRadii[] = {15, 20, 30, 40, 50};
+
     juce::File resourcesDir = juce::File::getCurrentWorkingDirectory().getChildFile("Resources");
     if (!resourcesDir.exists())
         resourcesDir.createDirectory();
 
-    int blurRadii[] = {15, 20, 30, 40, 50};
+    // Manifest of the parameter hash each file was last generated from
+    juce::File manifestFile = resourcesDir.getChildFile("glow_masks_manifest.json");
+    juce::var manifest = juce::JSON::parse(manifestFile);
+    if (!manifest.isObject())
+        manifest = juce::var(new juce::DynamicObject());
 
-    for (int p = 0; p < 3; ++p)
-    {
-        std::cout << "=== Preset: " << presets[p].name << " ===\n";
+    std::vector<LayerJob> jobs;
 
+    for (auto& maskSet : maskSets)
+    {
         for (int i = 0; i < 5; ++i)
         {
-            auto start = juce::Time::getMillisecondCounter();
-            std::cout << "  Layer " << i << " (size=" << presets[p].sizes[i]
-                      << ", blur=" << blurRadii[i] << ")..." << std::flush;
+            LayerJob job;
+            job.filename = juce::String("glow_mask_") + maskSet.name + "_layer_" + juce::String(i) + ".png";
+            job.size = maskSet.sizes[i];
+            job.alpha = layerAlphas[i];
+            job.blurRadius = blurRadii[i];
+            job.hash = hashLayerParameters(job.size, job.alpha, job.blurRadius);
+            jobs.push_back(job);
+        }
+    }
+
+    if (checkProcedural)
+    {
+        std::cout << "Comparing runtime-rendered glow masks with " << resourcesDir.getFullPathName() << "...\n\n";
+        bool passed = checkProceduralParity(jobs, resourcesDir);
+        std::cout << "\n" << (passed ? "All layers match" : "Some layers differ") << "\n";
 
-            juce::Image img = createBlurredGradient(presets[p].sizes[i], presets[p].colors[i], blurRadii[i]);
+        juce::shutdownJuce_GUI();
+        return passed ? 0 : 1;
+    }
 
-            juce::String filename = juce::String("glow_") + presets[p].name + "_layer_" + juce::String(i) + ".png";
-            juce::File outputFile = resourcesDir.getChildFile(filename);
-            juce::FileOutputStream stream(outputFile);
+    std::cout << "Generating glow masks for all presets...\n\n";
 
-            if (stream.openedOk())
-            {
-                juce::PNGImageFormat pngFormat;
-                pngFormat.writeImageToStream(img, stream);
+    std::vector<LayerJob*> queued;
 
-                auto elapsed = juce::Time::getMillisecondCounter() - start;
-                std::cout << " done (" << elapsed << "ms)\n";
-            }
-            else
-            {
-                std::cout << " FAILED to write file!\n";
-                return 1;
-            }
+    for (auto& job : jobs)
+    {
+        auto outputFile = resourcesDir.getChildFile(job.filename);
+        bool upToDate = outputFile.existsAsFile()
+                        && manifest.getProperty(job.filename, {}).toString() == job.hash;
+
+        if (upToDate && !force)
+        {
+            std::cout << "  " << job.filename << ": unchanged, skipped\n";
+            continue;
         }
-        std::cout << "\n";
+
+        job.queued = true;
+        queued.push_back(&job);
+    }
+
+    // The last job to finish wakes us, rather than polling the pool. The
+    // pool goes first, so no job outlives what it signals.
+    juce::WaitableEvent allDone;
+    std::atomic<int> numRemaining { (int)queued.size() };
+    juce::ThreadPool pool;
+
+    for (auto* job : queued)
+    {
+        auto outputFile = resourcesDir.getChildFile(job->filename);
+
+        pool.addJob([job, outputFile, &allDone, &numRemaining]
+        {
+            renderLayer(*job, outputFile);
+
+            if (--numRemaining == 0)
+                allDone.signal();
+        });
     }
 
-    std::cout << "All presets generated successfully in: " << resourcesDir.getFullPathName() << "\n";
+    if (!queued.empty())
+        allDone.wait();
+
+    bool anyFailed = false;
+
+    for (auto& job : jobs)
+    {
+        if (!job.queued)
+            continue;
+
+        std::cout << "  " << job.filename << " (size=" << job.size << ", blur=" << job.blurRadius << "): ";
+
+        if (job.failed)
+        {
+            std::cout << "FAILED to write file!\n";
+            anyFailed = true;
+            continue;
+        }
+
+        std::cout << (job.written ? "written" : "identical, not rewritten")
+                  << " (" << job.elapsedMs << "ms)\n";
+
+        manifest.getDynamicObject()->setProperty(job.filename, job.hash);
+    }
+
+    manifestFile.replaceWithText(juce::JSON::toString(manifest, false));
+
+    std::cout << "\n" << queued.size() << " of " << jobs.size() << " layers regenerated in: "
+              << resourcesDir.getFullPathName() << "\n";
 
     juce::shutdownJuce_GUI();
-    return 0;
+    return anyFailed ? 1 : 0;
 }
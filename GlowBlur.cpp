@@ -0,0 +1,309 @@
+#include "GlowBlur.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define GLOWBLUR_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define GLOWBLUR_NEON 1
+#endif
+
+namespace
+{
+    // One RGBA pixel per vector
+    struct Pixel4
+    {
+       #if GLOWBLUR_SSE
+        __m128 v;
+        static Pixel4 zero()                          { return { _mm_setzero_ps() }; }
+        static Pixel4 load(const float* p)            { return { _mm_loadu_ps(p) }; }
+        void store(float* p) const                    { _mm_storeu_ps(p, v); }
+        void addScaled(Pixel4 other, float weight)    { v = _mm_add_ps(v, _mm_mul_ps(other.v, _mm_set1_ps(weight))); }
+        void add(Pixel4 other)                        { v = _mm_add_ps(v, other.v); }
+        void subtract(Pixel4 other)                   { v = _mm_sub_ps(v, other.v); }
+        Pixel4 scaled(float weight) const             { return { _mm_mul_ps(v, _mm_set1_ps(weight)) }; }
+       #elif GLOWBLUR_NEON
+        float32x4_t v;
+        static Pixel4 zero()                          { return { vdupq_n_f32(0.0f) }; }
+        static Pixel4 load(const float* p)            { return { vld1q_f32(p) }; }
+        void store(float* p) const                    { vst1q_f32(p, v); }
+        void addScaled(Pixel4 other, float weight)    { v = vmlaq_n_f32(v, other.v, weight); }
+        void add(Pixel4 other)                        { v = vaddq_f32(v, other.v); }
+        void subtract(Pixel4 other)                   { v = vsubq_f32(v, other.v); }
+        Pixel4 scaled(float weight) const             { return { vmulq_n_f32(v, weight) }; }
+       #else
+        float v[4];
+        static Pixel4 zero()                          { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+        static Pixel4 load(const float* p)            { return { { p[0], p[1], p[2], p[3] } }; }
+        void store(float* p) const                    { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+        void addScaled(Pixel4 other, float weight)    { for (int i = 0; i < 4; ++i) v[i] += other.v[i] * weight; }
+        void add(Pixel4 other)                        { for (int i = 0; i < 4; ++i) v[i] += other.v[i]; }
+        void subtract(Pixel4 other)                   { for (int i = 0; i < 4; ++i) v[i] -= other.v[i]; }
+        Pixel4 scaled(float weight) const             { return { { v[0] * weight, v[1] * weight, v[2] * weight, v[3] * weight } }; }
+       #endif
+    };
+
+    int resolveThreadCount(int requested, int numJobs)
+    {
+        int threads = requested > 0 ? requested : (int)std::thread::hardware_concurrency();
+        return std::max(1, std::min(threads, numJobs));
+    }
+
+    // Runs fn(begin, end) over [0, count) split into contiguous chunks
+    template <typename Fn>
+    void parallelFor(int count, int numThreads, Fn&& fn)
+    {
+        numThreads = resolveThreadCount(numThreads, count);
+
+        if (numThreads == 1)
+        {
+            fn(0, count);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve((size_t)numThreads - 1);
+
+        int chunk = (count + numThreads - 1) / numThreads;
+
+        for (int t = 1; t < numThreads; ++t)
+        {
+            int begin = t * chunk;
+            int end = std::min(count, begin + chunk);
+
+            if (begin < end)
+                workers.emplace_back([&fn, begin, end] { fn(begin, end); });
+        }
+
+        fn(0, std::min(count, chunk));
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    // out[x] = sum over k of weights[k] * in[x + k - centre], zero outside 0..length
+    void convolveRow(const float* in, float* out, int length, int stride,
+                     const std::vector<float>& weights, int centre)
+    {
+        const int size = (int)weights.size();
+
+        for (int x = 0; x < length; ++x)
+        {
+            auto sum = Pixel4::zero();
+            int first = std::max(0, centre - x);
+            int last = std::min(size, length - x + centre);
+
+            for (int k = first; k < last; ++k)
+                sum.addScaled(Pixel4::load(in + (size_t)(x + k - centre) * (size_t)stride), weights[(size_t)k]);
+
+            sum.store(out + (size_t)x * (size_t)stride);
+        }
+    }
+
+    // Column pass over a band of output rows, one whole row at a time so the
+    // inner loop runs along contiguous memory
+    void convolveColumns(const float* in, float* out, int width, int height, int rowBegin, int rowEnd,
+                         const std::vector<float>& weights, int centre)
+    {
+        const int size = (int)weights.size();
+        const size_t rowFloats = (size_t)width * 4;
+
+        for (int y = rowBegin; y < rowEnd; ++y)
+        {
+            float* dest = out + (size_t)y * rowFloats;
+            std::fill(dest, dest + rowFloats, 0.0f);
+
+            int first = std::max(0, centre - y);
+            int last = std::min(size, height - y + centre);
+
+            for (int k = first; k < last; ++k)
+            {
+                const float* src = in + (size_t)(y + k - centre) * rowFloats;
+                const float weight = weights[(size_t)k];
+
+                for (int x = 0; x < width; ++x)
+                {
+                    auto sum = Pixel4::load(dest + (size_t)x * 4);
+                    sum.addScaled(Pixel4::load(src + (size_t)x * 4), weight);
+                    sum.store(dest + (size_t)x * 4);
+                }
+            }
+        }
+    }
+
+    // Running-sum box of the given radius along one line, zero outside
+    void boxLine(const float* in, float* out, int length, size_t stride, int radius)
+    {
+        const float scale = 1.0f / (float)(radius * 2 + 1);
+        auto sum = Pixel4::zero();
+
+        for (int x = 0; x < std::min(radius, length); ++x)
+            sum.add(Pixel4::load(in + (size_t)x * stride));
+
+        for (int x = 0; x < length; ++x)
+        {
+            int entering = x + radius;
+            int leaving = x - radius - 1;
+
+            if (entering < length)
+                sum.add(Pixel4::load(in + (size_t)entering * stride));
+            if (leaving >= 0)
+                sum.subtract(Pixel4::load(in + (size_t)leaving * stride));
+
+            sum.scaled(scale).store(out + (size_t)x * stride);
+        }
+    }
+
+    // Box radii for three passes approximating a Gaussian (Kovesi, 2010)
+    std::vector<int> boxRadiiForSigma(float sigma)
+    {
+        const int passes = 3;
+        double idealWidth = std::sqrt(12.0 * sigma * sigma / passes + 1.0);
+        int lower = (int)std::floor(idealWidth);
+        if (lower % 2 == 0)
+            --lower;
+        int upper = lower + 2;
+
+        double idealCount = (12.0 * sigma * sigma - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes)
+                            / (-4.0 * lower - 4.0);
+        int numLower = (int)std::round(idealCount);
+
+        std::vector<int> radii;
+        for (int i = 0; i < passes; ++i)
+            radii.push_back(((i < numLower ? lower : upper) - 1) / 2);
+
+        return radii;
+    }
+}
+
+GlowBlur::Buffer GlowBlur::fromImage(const juce::Image& image)
+{
+    auto argb = image.convertedToFormat(juce::Image::ARGB);
+
+    Buffer buffer;
+    buffer.width = argb.getWidth();
+    buffer.height = argb.getHeight();
+    buffer.pixels.resize((size_t)buffer.width * (size_t)buffer.height * 4);
+
+    juce::Image::BitmapData data(argb, juce::Image::BitmapData::readOnly);
+
+    for (int y = 0; y < buffer.height; ++y)
+    {
+        float* dest = buffer.pixels.data() + (size_t)y * (size_t)buffer.width * 4;
+
+        for (int x = 0; x < buffer.width; ++x)
+        {
+            const juce::uint8* src = data.getPixelPointer(x, y);
+
+            for (int c = 0; c < 4; ++c)
+                dest[x * 4 + c] = (float)src[c];
+        }
+    }
+
+    return buffer;
+}
+
+void GlowBlur::toImage(const Buffer& buffer, juce::Image& image)
+{
+    jassert(image.getFormat() == juce::Image::ARGB);
+    jassert(image.getWidth() == buffer.width && image.getHeight() == buffer.height);
+
+    juce::Image::BitmapData data(image, juce::Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < buffer.height; ++y)
+    {
+        const float* src = buffer.pixels.data() + (size_t)y * (size_t)buffer.width * 4;
+
+        for (int x = 0; x < buffer.width; ++x)
+        {
+            juce::uint8* dest = data.getPixelPointer(x, y);
+
+            // Same rounding and clamping as ImageConvolutionKernel::applyToImage()
+            for (int c = 0; c < 4; ++c)
+                dest[c] = (juce::uint8)juce::jmin(0xff, juce::roundToInt(src[x * 4 + c]));
+        }
+    }
+}
+
+void GlowBlur::gaussianBlur(Buffer& buffer, int kernelSize, float sigma, int numThreads)
+{
+    if (kernelSize <= 1 || buffer.width == 0 || buffer.height == 0)
+        return;
+
+    // ImageConvolutionKernel::createGaussianBlur() is exp(-(x^2 + y^2) / 2s^2),
+    // which is the outer product of this 1D kernel with itself
+    const int centre = kernelSize >> 1;
+    std::vector<float> weights((size_t)kernelSize);
+    double total = 0.0;
+
+    for (int k = 0; k < kernelSize; ++k)
+    {
+        double offset = k - centre;
+        weights[(size_t)k] = (float)std::exp(-offset * offset / (2.0 * sigma * sigma));
+        total += weights[(size_t)k];
+    }
+
+    for (auto& weight : weights)
+        weight = (float)(weight / total);
+
+    const int width = buffer.width;
+    const int height = buffer.height;
+    std::vector<float> temp(buffer.pixels.size());
+
+    // Rows
+    parallelFor(height, numThreads, [&](int begin, int end)
+    {
+        for (int y = begin; y < end; ++y)
+        {
+            size_t offset = (size_t)y * (size_t)width * 4;
+            convolveRow(buffer.pixels.data() + offset, temp.data() + offset, width, 4, weights, centre);
+        }
+    });
+
+    // Columns, in bands of output rows
+    parallelFor(height, numThreads, [&](int begin, int end)
+    {
+        convolveColumns(temp.data(), buffer.pixels.data(), width, height, begin, end, weights, centre);
+    });
+}
+
+void GlowBlur::boxBlur(Buffer& buffer, float sigma, int numThreads)
+{
+    if (sigma <= 0.0f || buffer.width == 0 || buffer.height == 0)
+        return;
+
+    const int width = buffer.width;
+    const int height = buffer.height;
+    const size_t rowFloats = (size_t)width * 4;
+    std::vector<float> temp(buffer.pixels.size());
+
+    for (int radius : boxRadiiForSigma(sigma))
+    {
+        if (radius <= 0)
+            continue;
+
+        parallelFor(height, numThreads, [&](int begin, int end)
+        {
+            for (int y = begin; y < end; ++y)
+                boxLine(buffer.pixels.data() + (size_t)y * rowFloats, temp.data() + (size_t)y * rowFloats,
+                        width, 4, radius);
+        });
+
+        parallelFor(width, numThreads, [&](int begin, int end)
+        {
+            for (int x = begin; x < end; ++x)
+                boxLine(temp.data() + (size_t)x * 4, buffer.pixels.data() + (size_t)x * 4,
+                        height, rowFloats, radius);
+        });
+    }
+}
+
+void GlowBlur::applyGaussianBlur(juce::Image& image, int kernelSize, float sigma, int numThreads)
+{
+    auto buffer = fromImage(image);
+    gaussianBlur(buffer, kernelSize, sigma, numThreads);
+    toImage(buffer, image);
+}
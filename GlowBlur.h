@@ -0,0 +1,35 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+#include <vector>
+
+// Blur engine shared by the glow generators. Works on premultiplied float
+// RGBA buffers, runs every pass as a 1D kernel (SSE/NEON, one pixel per
+// vector) and splits rows and columns across threads.
+class GlowBlur
+{
+public:
+    // Premultiplied RGBA, 4 floats per pixel in 0..255, rows packed
+    struct Buffer
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> pixels;
+    };
+
+    static Buffer fromImage(const juce::Image& image);
+    static void toImage(const Buffer& buffer, juce::Image& image);
+
+    // Same result as juce::ImageConvolutionKernel(kernelSize) with
+    // createGaussianBlur(sigma) and applyToImage() - zero outside the image,
+    // same tap alignment for even sizes - but O(kernelSize) per pixel instead
+    // of O(kernelSize^2)
+    static void gaussianBlur(Buffer& buffer, int kernelSize, float sigma, int numThreads = 0);
+
+    // Three box passes approximating a Gaussian of the given sigma. O(1) per
+    // pixel whatever the radius, for quick previews while designing
+    static void boxBlur(Buffer& buffer, float sigma, int numThreads = 0);
+
+    // Drop-in for the ImageConvolutionKernel code in createBlurredGradient()
+    static void applyGaussianBlur(juce::Image& image, int kernelSize, float sigma, int numThreads = 0);
+};
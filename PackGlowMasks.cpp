@@ -0,0 +1,108 @@
+#include <juce_graphics/juce_graphics.h>
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include "Source/GlowMaskFormat.h"
+
+// Build step: converts the glow mask PNGs into raw GlowMaskFormat blobs that
+// get embedded in GlowResources instead of the PNGs.
+//
+//   PackGlowMasks [--compare] <output dir> <mask.png>...
+//
+// --compare also times loading each mask the old way (PNG decode + conversion
+// to SingleChannel) against GlowMaskFormat::decode().
+
+static double averageMs(int iterations, const std::function<void()>& fn)
+{
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < iterations; ++i)
+        fn();
+
+    return (juce::Time::getMillisecondCounterHiRes() - start) / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::initialiseJuce_GUI();
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    bool compare = args.contains("--compare");
+    args.removeString("--compare");
+
+    if (args.size() < 2)
+    {
+        std::cout << "Usage: PackGlowMasks [--compare] <output dir> <mask.png>...\n";
+        juce::shutdownJuce_GUI();
+        return 1;
+    }
+
+    juce::File outputDir(args[0]);
+    outputDir.createDirectory();
+
+    double totalPngMs = 0.0;
+    double totalRawMs = 0.0;
+
+    for (int i = 1; i < args.size(); ++i)
+    {
+        juce::File pngFile(args[i]);
+        juce::MemoryBlock pngData;
+
+        if (!pngFile.loadFileAsData(pngData))
+        {
+            std::cout << "Can't read " << pngFile.getFullPathName() << "\n";
+            juce::shutdownJuce_GUI();
+            return 1;
+        }
+
+        auto image = juce::ImageFileFormat::loadFrom(pngData.getData(), pngData.getSize());
+
+        if (!image.isValid())
+        {
+            std::cout << "Not an image: " << pngFile.getFullPathName() << "\n";
+            juce::shutdownJuce_GUI();
+            return 1;
+        }
+
+        auto blob = GlowMaskFormat::encode(image);
+        auto outputFile = outputDir.getChildFile(pngFile.getFileNameWithoutExtension() + ".glowmask");
+
+        if (!outputFile.replaceWithData(blob.getData(), blob.getSize()))
+        {
+            std::cout << "Can't write " << outputFile.getFullPathName() << "\n";
+            juce::shutdownJuce_GUI();
+            return 1;
+        }
+
+        if (compare)
+        {
+            const int iterations = 50;
+
+            double pngMs = averageMs(iterations, [&]
+            {
+                juce::ImageFileFormat::loadFrom(pngData.getData(), pngData.getSize())
+                    .convertedToFormat(juce::Image::SingleChannel);
+            });
+
+            double rawMs = averageMs(iterations, [&]
+            {
+                GlowMaskFormat::decode(blob.getData(), blob.getSize());
+            });
+
+            totalPngMs += pngMs;
+            totalRawMs += rawMs;
+
+            std::cout << "  " << outputFile.getFileName() << ": "
+                      << image.getWidth() << "x" << image.getHeight()
+                      << ", png " << pngMs << "ms, raw " << rawMs << "ms\n";
+        }
+    }
+
+    if (compare)
+        std::cout << "Total for all masks: png " << totalPngMs << "ms, raw " << totalRawMs << "ms\n";
+
+    juce::shutdownJuce_GUI();
+    return 0;
+}
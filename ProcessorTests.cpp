@@ -0,0 +1,153 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <cmath>
+#include <vector>
+#include "Source/PluginProcessor.h"
+#include "Source/XYModulator.h"
+#include "Source/XYEffect.h"
+
+// Unit tests for XYControlAudioProcessor, run by ctest:
+//
+//   ctest --test-dir build --output-on-failure
+//   ./build/ProcessorTests
+//
+// They drive the processor the way a host does - prepareToPlay(), then
+// processBlock() with the parameters set between blocks - and hold its
+// output up against the same modulator and effect fed by hand.
+
+//==============================================================================
+// The plugin gets these from PluginEditor.cpp; the tests build the processor
+// on its own, without any of the UI
+bool XYControlAudioProcessor::hasEditor() const
+{
+    return false;
+}
+
+juce::AudioProcessorEditor* XYControlAudioProcessor::createEditor()
+{
+    return nullptr;
+}
+
+//==============================================================================
+// Host automation moving X and Y every block, through blocks longer than
+// prepareToPlay() promised, so processBlock() has to cut each block's ramp
+// into pieces. The reference gets each block's ramp whole, from the last
+// block's value to exactly this one's, and runs the same modulator and
+// effect over it in the same pieces. If a piece's ramp started anywhere but
+// where the last one stopped, or a block's ramp stopped short of its value,
+// the spring would head somewhere else and the two would part. Once the
+// automation stops, the two have to stay together on its last value.
+class ProcessBlockRampTest : public juce::UnitTest
+{
+public:
+    ProcessBlockRampTest() : juce::UnitTest("processBlock() automation ramps", "XYControl") {}
+
+    void runTest() override
+    {
+        beginTest("Ramps are continuous across pieces and land on each block's value");
+
+        constexpr double sampleRate = 48000.0;
+        constexpr int preparedSize = 64;
+        constexpr int blockSize = 512;
+        constexpr int numMovingBlocks = 32;
+        constexpr int numBlocks = numMovingBlocks + 64;   // Then held, till the spring settles
+
+        XYControlAudioProcessor processor;
+        auto& xParameter = *processor.parameters.getParameter(XYControlAudioProcessor::xParameterID.getParamID());
+        auto& yParameter = *processor.parameters.getParameter(XYControlAudioProcessor::yParameterID.getParamID());
+        auto& xValue = *processor.parameters.getRawParameterValue(XYControlAudioProcessor::xParameterID.getParamID());
+        auto& yValue = *processor.parameters.getRawParameterValue(XYControlAudioProcessor::yParameterID.getParamID());
+
+        processor.prepareToPlay(sampleRate, preparedSize);
+
+        float lastX = xValue.load();
+        float lastY = yValue.load();
+
+        XYModulator modulator;
+        modulator.prepare(sampleRate);
+        modulator.reset({ lastX, lastY });
+
+        XYEffect effect;
+        effect.prepare(sampleRate, preparedSize);
+        effect.reset(lastX, lastY);
+
+        juce::AudioBuffer<float> buffer(2, blockSize), expected(2, blockSize);
+        juce::MidiBuffer midi;
+        std::vector<float> rampX((size_t)blockSize), rampY((size_t)blockSize);
+        std::vector<float> modulationX((size_t)preparedSize), modulationY((size_t)preparedSize);
+        juce::Random random(7);
+        float maxDifference = 0.0f, maxPositionDifference = 0.0f;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            if (block < numMovingBlocks)
+            {
+                auto phase = (float)block * 0.4f;
+                xParameter.setValueNotifyingHost(0.5f + 0.45f * std::sin(phase));
+                yParameter.setValueNotifyingHost(0.5f + 0.45f * std::cos(phase * 0.7f));
+            }
+
+            // The values the processor will see, after the parameters' own rounding
+            float x = xValue.load();
+            float y = yValue.load();
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(channel, i, random.nextFloat() - 0.5f);
+
+            expected.makeCopyOf(buffer);
+            processor.processBlock(buffer, midi);
+
+            XYModulator::fillRamp(rampX.data(), lastX, x, blockSize);
+            XYModulator::fillRamp(rampY.data(), lastY, y, blockSize);
+            lastX = x;
+            lastY = y;
+
+            for (int start = 0; start < blockSize; start += preparedSize)
+            {
+                modulator.process(rampX.data() + start, rampY.data() + start,
+                                  modulationX.data(), modulationY.data(), preparedSize);
+
+                float* channels[] = { expected.getWritePointer(0, start), expected.getWritePointer(1, start) };
+                effect.process(channels, 2, preparedSize, modulationX.data(), modulationY.data());
+            }
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    maxDifference = juce::jmax(maxDifference, std::abs(buffer.getSample(channel, i) - expected.getSample(channel, i)));
+
+            auto position = processor.getModulatedPosition();
+            auto expectedPosition = modulator.getPosition();
+            maxPositionDifference = juce::jmax(maxPositionDifference, std::abs(position.x - expectedPosition.x),
+                                               std::abs(position.y - expectedPosition.y));
+        }
+
+        // The pieces' ramps are worked out from the block's ends rather than
+        // all in one go, so they're only rounding apart. Starting a piece
+        // from the block's start instead parts the springs by 0.01, and
+        // ending a block 1% short of its value by 0.002, and the output
+        // parts with them.
+        expectLessThan(maxPositionDifference, 1.0e-5f, "spring parts from a whole-block ramp");
+        expectLessThan(maxDifference, 1.0e-5f, "output parts from a whole-block ramp");
+        expectWithinAbsoluteError(modulator.getPosition().x, lastX, 1.0e-4f, "spring hasn't settled");
+        expectWithinAbsoluteError(modulator.getPosition().y, lastY, 1.0e-4f, "spring hasn't settled");
+    }
+};
+
+static ProcessBlockRampTest processBlockRampTest;
+
+//==============================================================================
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("XYControl");
+
+    int numFailures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i)->failures;
+
+    return numFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,1112 @@
+#include <juce_gui_extra/juce_gui_extra.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <vector>
+#include "Source/XYControlComponent.h"
+#include "Source/GlowCompositor.h"
+#include "Source/SpringPhysics.h"
+#include "Source/XYModulator.h"
+#include "Source/XYEffect.h"
+#include "Source/XYMorph.h"
+
+// Headless render benchmark for XYControlComponent::paint(). Renders the
+// component into an offscreen image through the software renderer, so it
+// runs without a display (e.g. on a Linux CI box):
+//
+//   ./build/RenderBenchmark [--frames N] [--size N] [--scale S] [--scenario NAME] [--compare]
+//   ./build/RenderBenchmark --physics [--frames N]
+//   ./build/RenderBenchmark --timestep
+//   ./build/RenderBenchmark --prediction [--size N]
+//   ./build/RenderBenchmark --modulator
+//   ./build/RenderBenchmark --automation
+//   ./build/RenderBenchmark --effect
+//   ./build/RenderBenchmark --morph
+//
+// Each frame steps the animation by 1/60 s, then times a full repaint and
+// counts the heap allocations made while painting. --compare runs every
+// scenario once per rendering variant (see createVariants()), oldest first.
+// --physics instead times SpringPhysics::step() over a range of cursor and
+// trail counts, and --timestep checks that a scripted drag moves the springs
+// identically at 30, 60, 120 and 144 Hz and with jittery, dropped ticks.
+// --prediction measures how much the cursor's predictive lead cuts its lag
+// behind a fast hand, and how far off its guesses are. --modulator checks
+// that the audio thread's spring follows the pad's, sample by sample, and
+// --automation that host automation lands on the right samples at any block
+// size. --effect times the plugin's XY effect at buffer sizes 16 to 2048,
+// and --morph the four-corner morph over 8 to 1024 parameters.
+
+//==============================================================================
+// Allocation counting: every operator new in the process comes through here,
+// but only the thread that is measuring a frame gets counted
+namespace AllocationCounter
+{
+    thread_local bool counting = false;
+    thread_local int64_t count = 0;
+    thread_local int64_t bytes = 0;
+
+    void* allocate(std::size_t size)
+    {
+        if (counting)
+        {
+            ++count;
+            bytes += (int64_t)size;
+        }
+
+        if (void* ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size)                    { return AllocationCounter::allocate(size); }
+void* operator new[](std::size_t size)                  { return AllocationCounter::allocate(size); }
+void operator delete(void* ptr) noexcept                { std::free(ptr); }
+void operator delete[](void* ptr) noexcept              { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept   { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+//==============================================================================
+struct FrameResult
+{
+    double renderMs = 0.0;
+    int64_t allocations = 0;
+    int64_t allocatedBytes = 0;
+};
+
+struct Variant
+{
+    const char* name;
+    XYControlComponent::RenderSettings settings;
+};
+
+struct Scenario
+{
+    const char* name;
+    int warmupFrames;                                           // Run but not measured
+    std::function<void(XYControlComponent&, int frame)> input;  // Before each step
+};
+
+static juce::MouseEvent makeMouseEvent(juce::Component& component, juce::Point<float> position, int numClicks = 1)
+{
+    auto now = juce::Time::getCurrentTime();
+
+    return juce::MouseEvent(juce::Desktop::getInstance().getMainMouseSource(), position,
+                            juce::ModifierKeys(juce::ModifierKeys::leftButtonModifier),
+                            juce::MouseInputSource::defaultPressure,
+                            juce::MouseInputSource::defaultOrientation,
+                            juce::MouseInputSource::defaultRotation,
+                            juce::MouseInputSource::defaultTiltX,
+                            juce::MouseInputSource::defaultTiltY,
+                            &component, &component, now, position, now, numClicks, false);
+}
+
+static FrameResult renderFrame(XYControlComponent& xyControl, juce::Image& frame, float scale)
+{
+    // Same backdrop MainComponent draws behind the control
+    frame.clear(frame.getBounds(), juce::Colours::white);
+
+    juce::Graphics g(frame);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
+    FrameResult result;
+    AllocationCounter::count = 0;
+    AllocationCounter::bytes = 0;
+    AllocationCounter::counting = true;
+    auto start = juce::Time::getHighResolutionTicks();
+
+    xyControl.paintEntireComponent(g, true);
+
+    auto end = juce::Time::getHighResolutionTicks();
+    AllocationCounter::counting = false;
+
+    result.renderMs = juce::Time::highResolutionTicksToSeconds(end - start) * 1000.0;
+    result.allocations = AllocationCounter::count;
+    result.allocatedBytes = AllocationCounter::bytes;
+    return result;
+}
+
+static std::vector<FrameResult> runScenario(const Scenario& scenario, const Variant& variant,
+                                           int numFrames, int size, float scale,
+                                           GlowSpriteAtlas::Stats& atlasStats)
+{
+    const double frameMs = 1000.0 / 60.0;
+
+    XYControlComponent xyControl;
+    xyControl.setSize(size, size);
+    xyControl.setRenderSettings(variant.settings);
+
+    juce::Image frame(juce::Image::ARGB, juce::roundToInt(size * scale), juce::roundToInt(size * scale), true);
+    std::vector<FrameResult> results;
+    results.reserve((size_t)numFrames);
+
+    for (int i = 0; i < scenario.warmupFrames + numFrames; ++i)
+    {
+        scenario.input(xyControl, i);
+        xyControl.stepAnimation(frameMs);
+
+        auto result = renderFrame(xyControl, frame, scale);
+
+        if (i >= scenario.warmupFrames)
+            results.push_back(result);
+    }
+
+    atlasStats = xyControl.getSpriteAtlasStats();
+    return results;
+}
+
+// Each rendering optimisation switched on in turn
+static std::vector<Variant> createVariants()
+{
+    std::vector<Variant> variants;
+    XYControlComponent::RenderSettings settings;
+
+    settings.cachedSurface = false;
+    settings.simdCompositor = false;
+    variants.push_back({ "path clip", settings });
+
+    settings.cachedSurface = true;
+    variants.push_back({ "cached surface", settings });
+
+    settings.simdCompositor = true;
+    variants.push_back({ "SIMD compositor", settings });
+
+    settings.tileParallel = true;
+    variants.push_back({ "tile parallel", settings });
+
+    settings.tileParallel = false;
+    settings.spriteAtlas = true;
+    variants.push_back({ "sprite atlas", settings });
+
+    return variants;
+}
+
+static std::vector<Scenario> createScenarios()
+{
+    std::vector<Scenario> scenarios;
+
+    // Settles, waits for breathing to start and blend in fully, then breathes
+    scenarios.push_back({ "idle breathing", 150, [](XYControlComponent&, int) {} });
+
+    // Quick circles around the pad, so every layer stays stretched into a comet
+    scenarios.push_back({ "fast drag (comet)", 10, [](XYControlComponent& xy, int frame)
+    {
+        auto centre = xy.getLocalBounds().getCentre().toFloat();
+        float radius = xy.getWidth() * 0.35f;
+        float angle = frame * juce::MathConstants<float>::twoPi / 40.0f;   // One lap in 2/3 s
+        juce::Point<float> position(centre.x + radius * std::cos(angle),
+                                    centre.y + radius * std::sin(angle * 2.0f) * 0.8f);
+
+        if (frame == 0)
+            xy.mouseDown(makeMouseEvent(xy, position));
+        else
+            xy.mouseDrag(makeMouseEvent(xy, position));
+    } });
+
+    // A double-click burst every 3/4 s
+    scenarios.push_back({ "disperse burst", 0, [](XYControlComponent& xy, int frame)
+    {
+        if (frame % 45 == 0)
+            xy.mouseDoubleClick(makeMouseEvent(xy, xy.getLocalBounds().getCentre().toFloat(), 2));
+    } });
+
+    // Next preset every 1/4 s while drifting slowly. The warmup goes through
+    // each preset once, so the measured frames only see cached masks.
+    scenarios.push_back({ "preset cycling", 45, [](XYControlComponent& xy, int frame)
+    {
+        if (frame % 15 == 0)
+            xy.setPreset(static_cast<XYControlComponent::Preset>((frame / 15) % 3));
+
+        auto centre = xy.getLocalBounds().getCentre().toFloat();
+        float angle = frame * juce::MathConstants<float>::twoPi / 240.0f;
+        juce::Point<float> position(centre.x + xy.getWidth() * 0.2f * std::cos(angle),
+                                    centre.y + xy.getHeight() * 0.2f * std::sin(angle));
+
+        if (frame == 0)
+            xy.mouseDown(makeMouseEvent(xy, position));
+        else
+            xy.mouseDrag(makeMouseEvent(xy, position));
+    } });
+
+    return scenarios;
+}
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    // Nearest rank
+    auto rank = (size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    return sorted[juce::jlimit((size_t)0, sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+static void printResults(const char* name, const char* variantName, const std::vector<FrameResult>& results)
+{
+    std::vector<double> times;
+    double totalMs = 0.0;
+    int64_t totalAllocations = 0, maxAllocations = 0, totalBytes = 0;
+
+    for (auto& result : results)
+    {
+        times.push_back(result.renderMs);
+        totalMs += result.renderMs;
+        totalAllocations += result.allocations;
+        totalBytes += result.allocatedBytes;
+        maxAllocations = juce::jmax(maxAllocations, result.allocations);
+    }
+
+    std::sort(times.begin(), times.end());
+    auto numFrames = (double)results.size();
+
+    std::cout << juce::String(name).paddedRight(' ', 20)
+              << juce::String(variantName).paddedRight(' ', 16)
+              << juce::String(totalMs / numFrames, 3).paddedLeft(' ', 8)
+              << juce::String(percentile(times, 50.0), 3).paddedLeft(' ', 8)
+              << juce::String(percentile(times, 90.0), 3).paddedLeft(' ', 8)
+              << juce::String(percentile(times, 99.0), 3).paddedLeft(' ', 8)
+              << juce::String(times.back(), 3).paddedLeft(' ', 8)
+              << juce::String((double)totalAllocations / numFrames, 1).paddedLeft(' ', 10)
+              << juce::String(maxAllocations).paddedLeft(' ', 8)
+              << juce::String((double)totalBytes / numFrames / 1024.0, 1).paddedLeft(' ', 10)
+              << "\n";
+}
+
+//==============================================================================
+static void runPhysicsBenchmark(int numFrames)
+{
+    std::cout << "SpringPhysics::step(), " << numFrames << " steps per case\n\n"
+              << juce::String("cursors").paddedRight(' ', 10)
+              << juce::String("trail").paddedRight(' ', 10)
+              << juce::String("springs").paddedLeft(' ', 10)
+              << juce::String("us/step").paddedLeft(' ', 10)
+              << juce::String("ns/spring").paddedLeft(' ', 12)
+              << "\n" << juce::String::repeatedString("-", 52) << "\n";
+
+    juce::Random random(1);
+
+    for (int numCursors : { 1, 4, 16, 64 })
+    {
+        for (int trailLength : { 5, 16, 64 })
+        {
+            SpringPhysics physics;
+
+            // A lengthening trail, like the glow layers
+            std::vector<SpringPhysics::Parameters> trail;
+
+            for (int i = 0; i < trailLength; ++i)
+            {
+                float t = (float)i / (float)trailLength;
+                trail.push_back({ 0.09f - 0.06f * t, 0.88f - 0.13f * t, 3.8f + 6.7f * t });
+            }
+
+            for (int c = 0; c < numCursors; ++c)
+                physics.addCursor({ 0.20f, 1.13f, 1.6f }, trail, { 0.5f, 0.5f });
+
+            // Timed as a whole, since one step is well under the clock's resolution
+            auto start = juce::Time::getMillisecondCounterHiRes();
+
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                // New targets now and then, so the springs are always moving
+                if (frame % 30 == 0)
+                    for (int c = 0; c < numCursors; ++c)
+                        physics.setTarget(c, random.nextFloat(), random.nextFloat());
+
+                physics.step(1.0f);
+            }
+
+            double totalMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+            int numSprings = numCursors * (1 + trailLength);
+            double usPerStep = totalMs * 1000.0 / numFrames;
+
+            std::cout << juce::String(numCursors).paddedRight(' ', 10)
+                      << juce::String(trailLength).paddedRight(' ', 10)
+                      << juce::String(numSprings).paddedLeft(' ', 10)
+                      << juce::String(usPerStep, 3).paddedLeft(' ', 10)
+                      << juce::String(usPerStep * 1000.0 / numSprings, 2).paddedLeft(' ', 12)
+                      << "\n";
+        }
+    }
+}
+
+//==============================================================================
+// Drives a component through the same drag with the clock ticking at the
+// given times, in ms. Mouse events only come on checkpoints, every 1/6 s,
+// which every tested rate lands on; the springs are recorded at each.
+static std::vector<SpringPhysics::State> runTimestepCase(const std::vector<double>& tickTimes)
+{
+    constexpr double checkpointMs = 1000.0 / 6.0;
+
+    XYControlComponent xy;
+    xy.setSize(500, 500);
+
+    std::vector<SpringPhysics::State> states;
+    double lastTime = 0.0;
+
+    for (double time : tickTimes)
+    {
+        xy.stepAnimation(time - lastTime);
+        lastTime = time;
+
+        auto checkpoint = juce::roundToInt(time / checkpointMs);
+
+        if (std::abs(time - checkpoint * checkpointMs) > 1.0e-6)
+            continue;
+
+        auto& snapshot = xy.getSimulationSnapshot();
+        states.insert(states.end(), snapshot.current.begin(), snapshot.current.end());
+
+        // Down, a zigzag for two seconds, then let go and settle
+        float angle = (float)checkpoint * 1.9f;
+        juce::Point<float> position(250.0f + 180.0f * std::cos(angle), 250.0f + 150.0f * std::sin(angle * 1.3f));
+
+        if (checkpoint == 0)
+            xy.mouseDown(makeMouseEvent(xy, position));
+        else if (checkpoint < 12)
+            xy.mouseDrag(makeMouseEvent(xy, position));
+        else if (checkpoint == 12)
+            xy.mouseUp(makeMouseEvent(xy, position));
+    }
+
+    return states;
+}
+
+static bool runTimestepCheck()
+{
+    constexpr int numCheckpoints = 30;      // 5 s
+    constexpr double checkpointMs = 1000.0 / 6.0;
+
+    auto evenTicks = [](int rateHz)
+    {
+        std::vector<double> times;
+
+        for (int i = 0; i <= numCheckpoints * rateHz / 6; ++i)
+            times.push_back(i * 1000.0 / rateHz);
+
+        return times;
+    };
+
+    // A random number of ticks per checkpoint, from none in between (a
+    // 167 ms hitch) to a dozen, at random times
+    juce::Random random(7);
+    std::vector<double> jitteryTicks { 0.0 };
+
+    for (int c = 0; c < numCheckpoints; ++c)
+    {
+        std::vector<double> between;
+
+        for (int i = random.nextInt(13); --i >= 0;)
+            between.push_back((c + random.nextDouble()) * checkpointMs);
+
+        std::sort(between.begin(), between.end());
+        jitteryTicks.insert(jitteryTicks.end(), between.begin(), between.end());
+        jitteryTicks.push_back((c + 1) * checkpointMs);
+    }
+
+    std::cout << "Fixed " << XYSimulation::stepMs << " ms physics steps, "
+              << numCheckpoints << " checkpoints over a drag, against 60 Hz\n\n";
+
+    auto reference = runTimestepCase(evenTicks(60));
+    bool allMatch = true;
+
+    auto report = [&](const juce::String& name, const std::vector<SpringPhysics::State>& states)
+    {
+        float maxDifference = 0.0f;
+
+        for (size_t i = 0; i < states.size() && i < reference.size(); ++i)
+            maxDifference = juce::jmax(maxDifference,
+                                       std::abs(states[i].x - reference[i].x), std::abs(states[i].y - reference[i].y),
+                                       juce::jmax(std::abs(states[i].vx - reference[i].vx),
+                                                  std::abs(states[i].vy - reference[i].vy)));
+
+        bool matches = states.size() == reference.size() && maxDifference == 0.0f;
+        allMatch = allMatch && matches;
+
+        std::cout << name.paddedRight(' ', 20) << (matches ? "identical" : "differs")
+                  << " (max difference " << maxDifference << ")\n";
+    };
+
+    for (int rateHz : { 30, 120, 144 })
+        report(juce::String(rateHz) + " Hz", runTimestepCase(evenTicks(rateHz)));
+
+    report("jittery", runTimestepCase(jitteryTicks));
+    return allMatch;
+}
+
+//==============================================================================
+// Where a synthetic hand is at timeMs: a figure-eight at varying speed for
+// 2.4 s, then a 0.6 s pause, over and over. In pad widths.
+static juce::Point<float> getHandPosition(double timeMs)
+{
+    double phase = juce::jmin(std::fmod(timeMs, 3000.0), 2400.0) / 2400.0 * juce::MathConstants<double>::twoPi;
+    phase += 0.4 * std::sin(phase * 3.0);
+
+    return { (float)(0.5 + 0.32 * std::sin(phase)), (float)(0.5 + 0.25 * std::sin(2.0 * phase)) };
+}
+
+// Feeds the hand to an XYSimulation as 1 kHz timestamped samples, rendering
+// at 60 Hz, once per predictive lead. Lag is how far the drawn cursor is from
+// where the hand is by the time the frame is on screen; the prediction error
+// is how far each predicted target was from where the hand then got to.
+static void runPredictionCheck(int size)
+{
+    constexpr double frameMs = 1000.0 / 60.0;
+    constexpr double durationMs = 12000.0;
+    constexpr double warmUpMs = 1000.0;
+    const double latencyMs = frameMs + XYSimulation::stepMs;
+    const float pixels = (float)size;
+
+    std::cout << "Predictive lead, 1 kHz samples drawn at 60 Hz, " << latencyMs << " ms to the screen, in px at "
+              << size << "x" << size << "\n\n"
+              << juce::String("lead ms").paddedRight(' ', 10)
+              << juce::String("lag").paddedLeft(' ', 10)
+              << juce::String("error").paddedLeft(' ', 10)
+              << juce::String("max").paddedLeft(' ', 10)
+              << juce::String("without").paddedLeft(' ', 10) << "\n";
+
+    for (float leadMs : { 0.0f, 8.0f, 16.0f, 24.0f, 32.0f, 48.0f })
+    {
+        XYSimulation simulation;
+        XYSimulation::Snapshot snapshot;
+        double startMs = simulation.getClockTime();
+
+        XYSimulation::Prediction prediction;
+        prediction.enabled = leadMs > 0.0f;
+        prediction.leadMs = leadMs;
+        simulation.setPrediction(prediction);
+
+        auto hand = getHandPosition(0.0);
+        simulation.post({ XYSimulation::Input::press, hand.x, hand.y, 0.0f, startMs });
+
+        double lagSum = 0.0;
+        int numFrames = 0;
+        double nextFrameMs = frameMs;
+
+        for (double timeMs = 1.0; timeMs <= durationMs; timeMs += 1.0)
+        {
+            auto position = getHandPosition(timeMs);
+
+            if (position != hand)
+            {
+                simulation.post({ XYSimulation::Input::drag, position.x, position.y, 0.0f, startMs + timeMs });
+                hand = position;
+            }
+
+            if (timeMs < nextFrameMs)
+                continue;
+
+            nextFrameMs += frameMs;
+            simulation.advanceTo(startMs + timeMs);
+            simulation.readLatest(snapshot);
+
+            if (timeMs < warmUpMs)
+                continue;
+
+            float alpha = (float)juce::jlimit(0.0, 1.0, (startMs + timeMs - snapshot.stepTimeMs) / XYSimulation::stepMs);
+            auto cursor = snapshot.getState(0, alpha);
+            auto shown = getHandPosition(timeMs + latencyMs);
+
+            lagSum += std::hypot(cursor.x - shown.x, cursor.y - shown.y);
+            ++numFrames;
+        }
+
+        auto& stats = snapshot.prediction;
+
+        std::cout << juce::String(leadMs).paddedRight(' ', 10)
+                  << juce::String(lagSum / numFrames * pixels, 2).paddedLeft(' ', 10)
+                  << juce::String(stats.meanError * pixels, 2).paddedLeft(' ', 10)
+                  << juce::String(stats.maxError * pixels, 2).paddedLeft(' ', 10)
+                  << juce::String(stats.meanErrorWithout * pixels, 2).paddedLeft(' ', 10) << "\n";
+    }
+
+    std::cout << "\nLag is the mean distance from the drawn cursor to the hand; error and max are\n"
+              << "the predicted targets against where the hand got to, without is the last sample's.\n";
+}
+
+//==============================================================================
+// Runs XYModulator in blocks, as the audio thread does, against the pad's
+// own simulation given the same targets at the same points. Sample by
+// sample the two should agree, and the biggest change between neighbouring
+// samples shows the curve is smooth rather than stepping at the spring rate.
+static bool runModulatorCheck()
+{
+    constexpr int numTargets = 12;
+    constexpr double holdMs = 200.0;    // Short enough to jump again mid-flight
+
+    std::cout << "XYModulator against XYSimulation's cursor, " << numTargets << " targets "
+              << holdMs << " ms apart\n\n"
+              << juce::String("rate").paddedRight(' ', 10)
+              << juce::String("block").paddedLeft(' ', 8)
+              << juce::String("max difference").paddedLeft(' ', 18)
+              << juce::String("max per sample").paddedLeft(' ', 18) << "\n";
+
+    bool allMatch = true;
+
+    for (double sampleRate : { 44100.0, 48000.0, 96000.0 })
+    {
+        for (int blockSize : { 64, 480 })
+        {
+            XYSimulation simulation;
+            XYSimulation::Snapshot snapshot;
+            simulation.readLatest(snapshot);
+
+            XYModulator modulator;
+            modulator.prepare(sampleRate);
+            modulator.reset({ 0.5f, 0.5f });
+
+            const double samplesPerStep = sampleRate * XYSimulation::stepMs / 1000.0;
+            const int blocksPerTarget = juce::roundToInt(holdMs * sampleRate / 1000.0 / blockSize);
+
+            std::vector<float> x((size_t)blockSize), y((size_t)blockSize);
+            juce::Random random(3);
+            double samplesIntoStep = 0.0;
+            float maxDifference = 0.0f, maxChange = 0.0f;
+            float lastX = 0.5f, lastY = 0.5f;
+
+            for (int block = 0; block < numTargets * blocksPerTarget; ++block)
+            {
+                // Both take a new target from their next step on
+                if (block % blocksPerTarget == 0)
+                {
+                    float targetX = random.nextFloat(), targetY = random.nextFloat();
+                    modulator.setTarget(targetX, targetY);
+                    simulation.post({ XYSimulation::Input::move, targetX, targetY });
+                }
+
+                modulator.process(x.data(), y.data(), blockSize);
+
+                for (size_t i = 0; i < x.size(); ++i)
+                {
+                    if (samplesIntoStep >= samplesPerStep)
+                    {
+                        samplesIntoStep -= samplesPerStep;
+                        simulation.runSteps(1);
+                        simulation.readLatest(snapshot);
+                    }
+
+                    auto expected = snapshot.getState(0, (float)(samplesIntoStep / samplesPerStep));
+                    samplesIntoStep += 1.0;
+
+                    maxDifference = juce::jmax(maxDifference, std::abs(x[i] - expected.x), std::abs(y[i] - expected.y));
+                    maxChange = juce::jmax(maxChange, std::abs(x[i] - lastX), std::abs(y[i] - lastY));
+                    lastX = x[i];
+                    lastY = y[i];
+                }
+            }
+
+            // Only rounding apart: the ramp is worked out incrementally
+            bool matches = maxDifference < 1.0e-5f;
+            allMatch = allMatch && matches;
+
+            std::cout << juce::String(sampleRate).paddedRight(' ', 10)
+                      << juce::String(blockSize).paddedLeft(' ', 8)
+                      << juce::String(maxDifference).paddedLeft(' ', 18)
+                      << juce::String(maxChange).paddedLeft(' ', 18)
+                      << (matches ? "" : "  differs") << "\n";
+        }
+    }
+
+    std::cout << "\nDifference and change per sample are in pad widths.\n";
+    return allMatch;
+}
+
+//==============================================================================
+// Host automation as the processor gets it - each parameter's value once per
+// block, as of the block's last sample - through the ramps processBlock()
+// builds from it. The automation is a triangle with a corner on the last
+// sample of every 2048, so at block sizes that divide 2048 the ramps should
+// rebuild it to rounding, and at any size each ramp must end on its block's
+// value exactly.
+// The spring on top should then move the same at every block size as it
+// does fed one sample at a time.
+static bool runAutomationCheck()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int cornerSpacing = 2048;
+    constexpr int length = cornerSpacing * 24;
+
+    auto automation = [](int sample)
+    {
+        int phase = (sample + 1 + 2 * cornerSpacing) % (2 * cornerSpacing);
+        return (float)(phase < cornerSpacing ? phase : 2 * cornerSpacing - phase) / (float)cornerSpacing;
+    };
+
+    // Renders the whole sweep at one block size, returning the spring's output
+    auto render = [&](int blockSize, float& rampError, float& steppedError, bool& endsExact)
+    {
+        XYModulator modulator;
+        modulator.prepare(sampleRate);
+        modulator.reset({ automation(-1), 0.5f });
+
+        std::vector<float> ramp((size_t)blockSize), still((size_t)blockSize, 0.5f), output((size_t)length);
+        float previous = automation(-1);
+
+        rampError = steppedError = 0.0f;
+        endsExact = true;
+
+        for (int start = 0; start < length; start += blockSize)
+        {
+            int numSamples = juce::jmin(blockSize, length - start);
+            float value = automation(start + numSamples - 1);
+
+            XYModulator::fillRamp(ramp.data(), previous, value, numSamples);
+            endsExact = endsExact && ramp[(size_t)numSamples - 1] == value;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                rampError = juce::jmax(rampError, std::abs(ramp[(size_t)i] - automation(start + i)));
+                steppedError = juce::jmax(steppedError, std::abs(value - automation(start + i)));
+            }
+
+            modulator.process(ramp.data(), still.data(), output.data() + start, nullptr, numSamples);
+            previous = value;
+        }
+
+        return output;
+    };
+
+    float rampError, steppedError;
+    bool endsExact;
+    auto reference = render(1, rampError, steppedError, endsExact);
+
+    std::cout << "Triangle automation at " << sampleRate << " Hz, corners every " << cornerSpacing
+              << " samples, against one sample per block\n\n"
+              << juce::String("block").paddedRight(' ', 8)
+              << juce::String("ends").paddedLeft(' ', 8)
+              << juce::String("ramp error").paddedLeft(' ', 14)
+              << juce::String("stepped").paddedLeft(' ', 14)
+              << juce::String("spring").paddedLeft(' ', 14) << "\n";
+
+    bool allMatch = true;
+
+    for (int blockSize : { 16, 64, 256, 480, 1024, 2048 })
+    {
+        auto output = render(blockSize, rampError, steppedError, endsExact);
+
+        float springDifference = 0.0f;
+
+        for (size_t i = 0; i < output.size(); ++i)
+            springDifference = juce::jmax(springDifference, std::abs(output[i] - reference[i]));
+
+        // 480 doesn't divide 2048, so its ramps cut the corners; only the
+        // ends have to be exact there
+        bool isAligned = cornerSpacing % blockSize == 0;
+        bool matches = endsExact && (!isAligned || (rampError < 1.0e-6f && springDifference < 1.0e-5f));
+        allMatch = allMatch && matches;
+
+        std::cout << juce::String(blockSize).paddedRight(' ', 8)
+                  << juce::String(endsExact ? "exact" : "off").paddedLeft(' ', 8)
+                  << juce::String(rampError).paddedLeft(' ', 14)
+                  << juce::String(steppedError).paddedLeft(' ', 14)
+                  << juce::String(springDifference).paddedLeft(' ', 14)
+                  << (matches ? "" : "  differs") << "\n";
+    }
+
+    std::cout << "\nErrors are the most any sample is off, as a fraction of the parameter's range;\n"
+              << "stepped is the block's value held from its first sample, without ramps.\n";
+    return allMatch;
+}
+
+//==============================================================================
+// XYEffect as processBlock() runs it: ten seconds of stereo noise at 48 kHz,
+// with the pad swept round through the modulator, at each buffer size from
+// 16 to 2048. Reports the time per block and per sample, checks nothing is
+// allocated while processing, and that the output doesn't depend on the
+// buffer size.
+static bool runEffectBenchmark()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int length = 48000 * 10;
+    constexpr int numRuns = 5;          // Best of, since it's over in milliseconds
+
+    std::vector<float> inputLeft((size_t)length), inputRight((size_t)length);
+    std::vector<float> x((size_t)length), y((size_t)length);
+
+    juce::Random random(5);
+
+    for (size_t i = 0; i < inputLeft.size(); ++i)
+    {
+        inputLeft[i] = random.nextFloat() - 0.5f;
+        inputRight[i] = random.nextFloat() - 0.5f;
+    }
+
+    {
+        // Slow circles through every corner, as a hand might
+        std::vector<float> targetX((size_t)length), targetY((size_t)length);
+
+        for (size_t i = 0; i < targetX.size(); ++i)
+        {
+            double seconds = (double)i / sampleRate;
+            targetX[i] = (float)(0.5 + 0.5 * std::sin(seconds * 2.1));
+            targetY[i] = (float)(0.5 + 0.5 * std::sin(seconds * 1.3 + 1.0));
+        }
+
+        XYModulator modulator;
+        modulator.prepare(sampleRate);
+        modulator.reset({ targetX[0], targetY[0] });
+        modulator.process(targetX.data(), targetY.data(), x.data(), y.data(), length);
+    }
+
+    std::cout << "XYEffect::process(), stereo at " << sampleRate << " Hz, best of " << numRuns << "\n\n"
+              << juce::String("block").paddedRight(' ', 8)
+              << juce::String("us/block").paddedLeft(' ', 10)
+              << juce::String("ns/sample").paddedLeft(' ', 11)
+              << juce::String("% of block").paddedLeft(' ', 12)
+              << juce::String("allocs").paddedLeft(' ', 8)
+              << juce::String("difference").paddedLeft(' ', 12) << "\n";
+
+    std::vector<float> referenceLeft;
+    bool allMatch = true;
+
+    for (int blockSize = 16; blockSize <= 2048; blockSize *= 2)
+    {
+        std::vector<float> left, right;
+        double bestMs = std::numeric_limits<double>::max();
+        int64_t allocations = 0;
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            XYEffect effect;
+            effect.prepare(sampleRate, blockSize);
+            effect.reset(x[0], y[0]);
+
+            left = inputLeft;
+            right = inputRight;
+
+            AllocationCounter::count = 0;
+            AllocationCounter::counting = true;
+            auto start = juce::Time::getMillisecondCounterHiRes();
+
+            for (int offset = 0; offset < length; offset += blockSize)
+            {
+                float* channels[] = { left.data() + offset, right.data() + offset };
+                effect.process(channels, 2, juce::jmin(blockSize, length - offset),
+                               x.data() + offset, y.data() + offset);
+            }
+
+            bestMs = juce::jmin(bestMs, juce::Time::getMillisecondCounterHiRes() - start);
+            AllocationCounter::counting = false;
+            allocations += AllocationCounter::count;
+        }
+
+        if (referenceLeft.empty())
+            referenceLeft = left;
+
+        float difference = 0.0f;
+
+        for (size_t i = 0; i < left.size(); ++i)
+            difference = juce::jmax(difference, std::abs(left[i] - referenceLeft[i]));
+
+        bool matches = allocations == 0 && difference == 0.0f;
+        allMatch = allMatch && matches;
+
+        auto numBlocks = (length + blockSize - 1) / blockSize;
+        auto usPerBlock = bestMs * 1000.0 / numBlocks;
+        auto blockUs = blockSize * 1.0e6 / sampleRate;
+
+        std::cout << juce::String(blockSize).paddedRight(' ', 8)
+                  << juce::String(usPerBlock, 2).paddedLeft(' ', 10)
+                  << juce::String(bestMs * 1.0e6 / length, 1).paddedLeft(' ', 11)
+                  << juce::String(usPerBlock / blockUs * 100.0, 3).paddedLeft(' ', 12)
+                  << juce::String(allocations).paddedLeft(' ', 8)
+                  << juce::String(difference).paddedLeft(' ', 12)
+                  << (matches ? "" : "  differs") << "\n";
+    }
+
+    std::cout << "\n% of block is of the block's own duration, on one core. Difference is against\n"
+              << "16-sample blocks; the controls are worked out on a grid that ignores block size.\n";
+    return allMatch;
+}
+
+//==============================================================================
+// XYMorph as processBlock() runs it, once per 512-sample block at 48 kHz,
+// over ten seconds of the pad swept round and stopping through the
+// modulator, with random corners. Times a call, counts how many values it reports against
+// sending every value every block, and checks that the values match a plain
+// bilinear blend, that the host's copy never lags them by more than
+// XYMorph::threshold, and that nothing is allocated.
+static bool runMorphBenchmark()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 48000 * 10 / blockSize;
+    constexpr int numRuns = 200;        // The whole sweep, to time it in microseconds not nanoseconds
+
+    std::vector<float> x((size_t)numBlocks), y((size_t)numBlocks);
+
+    {
+        constexpr int length = numBlocks * blockSize;
+        std::vector<float> targetX((size_t)length), targetY((size_t)length);
+        std::vector<float> modulationX((size_t)length), modulationY((size_t)length);
+
+        // The effect's circles, but held still for a second after every
+        // second and a half of them, as a hand would now and then
+        for (size_t i = 0; i < targetX.size(); ++i)
+        {
+            double elapsed = (double)i / sampleRate;
+            double seconds = std::floor(elapsed / 2.5) * 1.5 + juce::jmin(std::fmod(elapsed, 2.5), 1.5);
+            targetX[i] = (float)(0.5 + 0.5 * std::sin(seconds * 2.1));
+            targetY[i] = (float)(0.5 + 0.5 * std::sin(seconds * 1.3 + 1.0));
+        }
+
+        XYModulator modulator;
+        modulator.prepare(sampleRate);
+        modulator.reset({ targetX[0], targetY[0] });
+        modulator.process(targetX.data(), targetY.data(), modulationX.data(), modulationY.data(), length);
+
+        // Where the spring got to by the end of each block
+        for (size_t block = 0; block < x.size(); ++block)
+        {
+            x[block] = modulationX[(block + 1) * blockSize - 1];
+            y[block] = modulationY[(block + 1) * blockSize - 1];
+        }
+    }
+
+    std::cout << "XYMorph::process(), once per " << blockSize << "-sample block at " << sampleRate << " Hz\n\n"
+              << juce::String("params").paddedRight(' ', 8)
+              << juce::String("ns/call").paddedLeft(' ', 10)
+              << juce::String("ns/param").paddedLeft(' ', 10)
+              << juce::String("sent").paddedLeft(' ', 8)
+              << juce::String("allocs").paddedLeft(' ', 8)
+              << juce::String("error").paddedLeft(' ', 12)
+              << juce::String("host lag").paddedLeft(' ', 12) << "\n";
+
+    bool allMatch = true;
+
+    for (int numParameters = 8; numParameters <= 1024; numParameters *= 2)
+    {
+        std::vector<std::vector<float>> corners((size_t)XYMorph::numCorners, std::vector<float>((size_t)numParameters));
+        juce::Random random(numParameters);
+
+        XYMorph morph;
+        morph.setNumParameters(numParameters);
+
+        for (int corner = 0; corner < XYMorph::numCorners; ++corner)
+        {
+            for (auto& value : corners[(size_t)corner])
+                value = random.nextFloat();
+
+            morph.setCorner(corner, corners[(size_t)corner].data());
+        }
+
+        // What the host has been told, and how many values that took
+        std::vector<float> host((size_t)numParameters, 0.0f);
+        int64_t numSent = 0;
+        float error = 0.0f, lag = 0.0f;
+
+        for (size_t block = 0; block < x.size(); ++block)
+        {
+            auto numChanges = morph.process(x[block], y[block]);
+            auto* values = morph.getValues();
+
+            for (int i = 0; i < numChanges; ++i)
+                host[(size_t)morph.getChanges()[i]] = values[morph.getChanges()[i]];
+
+            numSent += numChanges;
+
+            float wx = x[block], wy = y[block];
+
+            for (size_t i = 0; i < host.size(); ++i)
+            {
+                float expected = ((corners[0][i] * ((1.0f - wx) * (1.0f - wy)) + corners[1][i] * (wx * (1.0f - wy)))
+                                   + corners[2][i] * ((1.0f - wx) * wy)) + corners[3][i] * (wx * wy);
+                error = juce::jmax(error, std::abs(values[i] - expected));
+                lag = juce::jmax(lag, std::abs(values[i] - host[i]));
+            }
+        }
+
+        double bestMs = std::numeric_limits<double>::max();
+        int64_t allocations = 0;
+
+        for (int run = 0; run < 5; ++run)
+        {
+            AllocationCounter::count = 0;
+            AllocationCounter::counting = true;
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            int64_t sink = 0;
+
+            for (int repeat = 0; repeat < numRuns; ++repeat)
+                for (size_t block = 0; block < x.size(); ++block)
+                    sink += morph.process(x[block], y[block]);
+
+            bestMs = juce::jmin(bestMs, juce::Time::getMillisecondCounterHiRes() - start);
+            AllocationCounter::counting = false;
+            allocations += AllocationCounter::count;
+
+            if (sink < 0)
+                std::cout << sink;
+        }
+
+        bool matches = allocations == 0 && error == 0.0f && lag <= XYMorph::threshold;
+        allMatch = allMatch && matches;
+
+        auto nsPerCall = bestMs * 1.0e6 / ((double)numRuns * (double)x.size());
+
+        std::cout << juce::String(numParameters).paddedRight(' ', 8)
+                  << juce::String(nsPerCall, 1).paddedLeft(' ', 10)
+                  << juce::String(nsPerCall / numParameters, 2).paddedLeft(' ', 10)
+                  << (juce::String(100.0 * (double)numSent / ((double)numParameters * (double)x.size()), 1) + "%").paddedLeft(' ', 8)
+                  << juce::String(allocations).paddedLeft(' ', 8)
+                  << juce::String(error).paddedLeft(' ', 12)
+                  << juce::String(lag).paddedLeft(' ', 12)
+                  << (matches ? "" : "  differs") << "\n";
+    }
+
+    std::cout << "\nSent is the values reported, against every value every block. Error is against\n"
+              << "a plain bilinear blend; host lag is how far a value got from the last one sent.\n";
+    return allMatch;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    int numFrames = 600;
+    int size = 500;        // As laid out by MainComponent
+    float scale = 1.0f;
+    juce::String onlyScenario;
+    bool compare = false;
+    bool physics = false;
+    bool timestep = false;
+    bool prediction = false;
+    bool modulation = false;
+    bool automation = false;
+    bool effect = false;
+    bool morph = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--frames" && hasValue)
+            numFrames = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (arg == "--size" && hasValue)
+            size = juce::jmax(50, juce::String(argv[++i]).getIntValue());
+        else if (arg == "--scale" && hasValue)
+            scale = juce::jlimit(1.0f, 4.0f, juce::String(argv[++i]).getFloatValue());
+        else if (arg == "--scenario" && hasValue)
+            onlyScenario = argv[++i];
+        else if (arg == "--compare")
+            compare = true;
+        else if (arg == "--physics")
+            physics = true;
+        else if (arg == "--timestep")
+            timestep = true;
+        else if (arg == "--prediction")
+            prediction = true;
+        else if (arg == "--modulator")
+            modulation = true;
+        else if (arg == "--automation")
+            automation = true;
+        else if (arg == "--effect")
+            effect = true;
+        else if (arg == "--morph")
+            morph = true;
+        else
+        {
+            std::cout << "Usage: RenderBenchmark [--frames N] [--size N] [--scale S] [--scenario NAME] [--compare]\n"
+                      << "       RenderBenchmark --physics [--frames N]\n"
+                      << "       RenderBenchmark --timestep\n"
+                      << "       RenderBenchmark --prediction [--size N]\n"
+                      << "       RenderBenchmark --modulator\n"
+                      << "       RenderBenchmark --automation\n"
+                      << "       RenderBenchmark --effect\n"
+                      << "       RenderBenchmark --morph\n";
+            return 1;
+        }
+    }
+
+    if (physics)
+    {
+        runPhysicsBenchmark(numFrames * 100);
+        return 0;
+    }
+
+    if (timestep)
+        return runTimestepCheck() ? 0 : 1;
+
+    if (prediction)
+    {
+        runPredictionCheck(size);
+        return 0;
+    }
+
+    if (modulation)
+        return runModulatorCheck() ? 0 : 1;
+
+    if (automation)
+        return runAutomationCheck() ? 0 : 1;
+
+    if (effect)
+        return runEffectBenchmark() ? 0 : 1;
+
+    if (morph)
+        return runMorphBenchmark() ? 0 : 1;
+
+    // Held for the whole run, so the tile workers start once rather than per scenario
+    juce::SharedResourcePointer<GlowCompositor::WorkerPool> compositorWorkers;
+
+    std::cout << "XYControlComponent::paint(), " << size << "x" << size << " at " << scale << "x, "
+              << numFrames << " frames per scenario, " << GlowCompositor::getInstructionSetName()
+              << " compositor, " << compositorWorkers->getNumWorkers()
+              << " worker threads\n\n";
+
+    std::cout << juce::String("scenario").paddedRight(' ', 20)
+              << juce::String("variant").paddedRight(' ', 16)
+              << juce::String("mean").paddedLeft(' ', 8)
+              << juce::String("p50").paddedLeft(' ', 8)
+              << juce::String("p90").paddedLeft(' ', 8)
+              << juce::String("p99").paddedLeft(' ', 8)
+              << juce::String("max").paddedLeft(' ', 8)
+              << juce::String("allocs").paddedLeft(' ', 10)
+              << juce::String("max").paddedLeft(' ', 8)
+              << juce::String("KB").paddedLeft(' ', 10)
+              << "\n" << juce::String::repeatedString("-", 96) << "\n";
+
+    auto variants = createVariants();
+
+    // Without --compare, just the default settings
+    if (!compare)
+    {
+        XYControlComponent::RenderSettings defaults;
+
+        variants.erase(std::remove_if(variants.begin(), variants.end(), [&](const Variant& variant)
+        {
+            return variant.settings.cachedSurface != defaults.cachedSurface
+                || variant.settings.simdCompositor != defaults.simdCompositor
+                || variant.settings.tileParallel != defaults.tileParallel
+                || variant.settings.spriteAtlas != defaults.spriteAtlas;
+        }), variants.end());
+    }
+
+    for (auto& scenario : createScenarios())
+    {
+        if (onlyScenario.isNotEmpty() && !juce::String(scenario.name).startsWithIgnoreCase(onlyScenario))
+            continue;
+
+        for (auto& variant : variants)
+        {
+            GlowSpriteAtlas::Stats atlasStats;
+            printResults(scenario.name, variant.name, runScenario(scenario, variant, numFrames, size, scale, atlasStats));
+
+            // Stamps render in the background while frames run flat out, so
+            // the hit rate here is a floor on what a 60 Hz editor gets
+            auto lookups = atlasStats.hits + atlasStats.misses;
+
+            if (lookups > 0)
+                std::cout << juce::String::repeatedString(" ", 20) << "  "
+                          << juce::String(100.0 * (double)atlasStats.hits / (double)lookups, 1) << "% of layers from stamps, "
+                          << atlasStats.numStamps << " stamps in "
+                          << juce::String((double)atlasStats.stampBytes / (1024.0 * 1024.0), 1) << " MB, "
+                          << atlasStats.numBins << " bins\n";
+        }
+    }
+
+    std::cout << "\nTimes in ms per frame; allocs and KB are heap allocations per frame while painting.\n";
+    return 0;
+}
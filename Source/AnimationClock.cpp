@@ -0,0 +1,172 @@
+#include "AnimationClock.h"
+
+AnimationClock::AnimationClock()
+{
+    activeClients.reserve(16);
+    clientsThisFrame.reserve(16);
+}
+
+AnimationClock::~AnimationClock()
+{
+    vblankAttachment.reset();
+}
+
+void AnimationClock::setFrameRate(Client& client, juce::Component& owner, int rateHz)
+{
+    auto it = std::find_if(activeClients.begin(), activeClients.end(),
+                           [&client](const ActiveClient& c) { return c.client == &client; });
+
+    if (rateHz <= 0)
+    {
+        if (it != activeClients.end())
+        {
+            // Clients drop out from inside their own advanceAnimation(), so
+            // only mark them here and compact once the tick is over
+            it->client = nullptr;
+            detachOwner(owner);
+
+            if (!isTicking)
+                removeInactiveClients();
+        }
+
+        return;
+    }
+
+    if (it != activeClients.end())
+    {
+        it->intervalMs = 1000.0 / rateHz;
+        return;
+    }
+
+    activeClients.push_back({ &client, &owner, 1000.0 / rateHz, 0.0 });
+
+    if (!isTimerRunning())
+        startTimerHz(60);
+
+    if (vblankOwner == nullptr && !isTicking)
+        attachToDisplay();
+}
+
+void AnimationClock::removeClient(Client& client, juce::Component& owner)
+{
+    for (auto& active : activeClients)
+        if (active.client == &client)
+            active.client = nullptr;
+
+    // Even if the client had already stopped, the attachment may still be on
+    // its owner
+    detachOwner(owner);
+
+    if (!isTicking)
+        removeInactiveClients();
+}
+
+int AnimationClock::getNumActiveClients() const
+{
+    return (int)std::count_if(activeClients.begin(), activeClients.end(),
+                              [](const ActiveClient& c) { return c.client != nullptr; });
+}
+
+void AnimationClock::removeInactiveClients()
+{
+    activeClients.erase(std::remove_if(activeClients.begin(), activeClients.end(),
+                                       [](const ActiveClient& c) { return c.client == nullptr; }),
+                        activeClients.end());
+}
+
+void AnimationClock::attachToDisplay()
+{
+    // Prefer a client that's actually on screen, its peer is the one with a vblank
+    juce::Component* owner = nullptr;
+
+    for (auto& active : activeClients)
+    {
+        if (active.client == nullptr)
+            continue;
+
+        if (owner == nullptr || (!owner->isShowing() && active.owner->isShowing()))
+            owner = active.owner;
+    }
+
+    if (owner == vblankOwner)
+        return;
+
+    vblankAttachment.reset();
+    vblankOwner = owner;
+
+    if (owner != nullptr)
+    {
+        vblankAttachment = std::make_unique<juce::VBlankAttachment>(owner, [this]
+        {
+            lastVBlankMs = juce::Time::getMillisecondCounterHiRes();
+            tick(lastVBlankMs);
+        });
+    }
+}
+
+void AnimationClock::detachOwner(juce::Component& owner)
+{
+    // The attachment must go before its component does. The timer picks
+    // another owner if anything is still ticking.
+    if (&owner == vblankOwner)
+    {
+        vblankAttachment.reset();
+        vblankOwner = nullptr;
+    }
+}
+
+void AnimationClock::timerCallback()
+{
+    // Housekeeping lives here rather than in tick(), which may be running
+    // inside the vblank attachment's own callback
+    removeInactiveClients();
+
+    if (activeClients.empty())
+    {
+        vblankAttachment.reset();
+        vblankOwner = nullptr;
+        stopTimer();
+        return;
+    }
+
+    auto nowMs = juce::Time::getMillisecondCounterHiRes();
+
+    if (nowMs - lastVBlankMs > vblankTimeoutMs)
+    {
+        // No vblank: the platform has none, or the anchor went off screen
+        if (vblankOwner == nullptr || !vblankOwner->isShowing())
+            attachToDisplay();
+
+        tick(nowMs);
+    }
+}
+
+void AnimationClock::tick(double nowMs)
+{
+    // A client may run a modal loop from inside its callbacks
+    if (isTicking)
+        return;
+
+    isTicking = true;
+    clientsThisFrame.clear();
+
+    // Pass 1: step every client that's due. Clients added during the pass
+    // wait for the next frame.
+    for (size_t i = 0, numClients = activeClients.size(); i < numClients; ++i)
+    {
+        auto* client = activeClients[i].client;
+
+        if (client == nullptr || nowMs - activeClients[i].lastFrameMs < activeClients[i].intervalMs - frameSlackMs)
+            continue;
+
+        activeClients[i].lastFrameMs = nowMs;
+        clientsThisFrame.push_back(client);
+        client->advanceAnimation(nowMs);
+    }
+
+    // Pass 2: all the repaints in one go
+    for (auto* client : clientsThisFrame)
+        client->flushAnimation();
+
+    isTicking = false;
+}
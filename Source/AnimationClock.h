@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <algorithm>
+#include <vector>
+
+// One animation clock per process, shared through juce::SharedResourcePointer.
+// Ticks on the display's vblank where the platform has one, with a 60 Hz timer
+// as fallback. Each tick steps every due client first, then lets them all
+// repaint together, so the cost follows the number of animating clients rather
+// than the number of open editors.
+class AnimationClock : private juce::Timer
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Step animation state up to timeMs (Time::getMillisecondCounterHiRes)
+        virtual void advanceAnimation(double timeMs) = 0;
+
+        // Issue repaints for the frame that was just advanced
+        virtual void flushAnimation() = 0;
+    };
+
+    AnimationClock();
+    ~AnimationClock() override;
+
+    // A rate of 0 takes the client out of the tick entirely
+    void setFrameRate(Client& client, juce::Component& owner, int rateHz);
+
+    // Must be called before the client or its owner goes, whether or not
+    // it's still ticking
+    void removeClient(Client& client, juce::Component& owner);
+
+    int getNumActiveClients() const;
+
+private:
+    struct ActiveClient
+    {
+        Client* client = nullptr;       // nullptr once removed mid-tick
+        juce::Component* owner = nullptr;
+        double intervalMs = 0.0;
+        double lastFrameMs = 0.0;
+    };
+
+    void timerCallback() override;
+    void tick(double nowMs);
+    void removeInactiveClients();
+    void attachToDisplay();
+    void detachOwner(juce::Component& owner);
+
+    std::vector<ActiveClient> activeClients;
+    std::vector<Client*> clientsThisFrame;
+
+    std::unique_ptr<juce::VBlankAttachment> vblankAttachment;
+    juce::Component* vblankOwner = nullptr;
+    double lastVBlankMs = 0.0;
+    bool isTicking = false;
+
+    // A 60 Hz client shouldn't miss a 60 Hz vblank because of a little jitter
+    static constexpr double frameSlackMs = 2.0;
+
+    // Fall back to the timer when no vblank has arrived for this long
+    static constexpr double vblankTimeoutMs = 50.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnimationClock)
+};
@@ -0,0 +1,888 @@
+#include "GlowCompositor.h"
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <immintrin.h>
+ #define GLOWCOMPOSITOR_SSE 1
+ #if defined(_MSC_VER) && !defined(__clang__)
+  #define GLOWCOMPOSITOR_AVX2_FUNCTION
+ #else
+  #define GLOWCOMPOSITOR_AVX2_FUNCTION __attribute__((target("avx2")))
+ #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define GLOWCOMPOSITOR_NEON 1
+#endif
+
+namespace
+{
+    // A layer set up for the kernels. Sample positions are in padded mask
+    // pixels, shifted so floor() gives the top-left bilinear tap:
+    //   s = ds/dx * x + ds/dy * y + s0   for frame pixel (x, y)
+    struct Sprite
+    {
+        const juce::uint8* mask;
+        int stride;
+        float maxU, maxV;           // Keeps both taps inside the padding
+        float dudx, dudy, u0;
+        float dvdx, dvdy, v0;
+        juce::uint32 colour;        // Premultiplied, native byte order
+        int colourAlpha;
+
+        // Stamps only: frame pixel (x, y) takes its top-left tap from stamp
+        // column x + stampDx of row y + stampDy, with fixed bilinear weights
+        const GlowCompositor::Stamp* stamp;
+        bool flipped;
+        int stampDx, stampDy;
+        int weights[4];             // Top-left, top-right, bottom-left, bottom-right; sum to 256
+    };
+
+    using RowFunction = void (*)(const Sprite&, juce::uint32* row, float uRow, float vRow, int xStart, int xEnd);
+    using StampRowFunction = void (*)(const Sprite&, const juce::uint8* top, const juce::uint8* bottom,
+                                      juce::uint32* row, int count);
+
+    // Bilinear mask sample as a 0..256 blend factor. The SIMD kernels do the
+    // same multiplies and adds in the same order and round the same way, so
+    // they give the same factors.
+    forcedinline int sampleCoverage(const Sprite& sprite, float u, float v)
+    {
+        u = juce::jlimit(0.0f, sprite.maxU, u);
+        v = juce::jlimit(0.0f, sprite.maxV, v);
+
+        int ix = (int)u;
+        int iy = (int)v;
+        float fx = u - (float)ix;
+        float fy = v - (float)iy;
+
+        const juce::uint8* p = sprite.mask + iy * sprite.stride + ix;
+        float top = p[0] + (p[1] - p[0]) * fx;
+        float bottom = p[sprite.stride] + (p[sprite.stride + 1] - p[sprite.stride]) * fx;
+
+        return (int)((top + (bottom - top) * fy) * (256.0f / 255.0f) + 0.5f);
+    }
+
+    // dest = tint * k + dest * (1 - tintAlpha * k), per byte, so it works in
+    // either byte order
+    forcedinline void blendPixel(juce::uint32& dest, juce::uint32 colour, int colourAlpha, int k)
+    {
+        int inverse = 256 - ((colourAlpha * k) >> 8);
+        juce::uint32 result = 0;
+
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            int source = ((int)((colour >> shift) & 0xff) * k) >> 8;
+            int existing = (int)((dest >> shift) & 0xff);
+            result |= (juce::uint32)juce::jmin(255, source + ((existing * inverse) >> 8)) << shift;
+        }
+
+        dest = result;
+    }
+
+    void compositeRowScalar(const Sprite& sprite, juce::uint32* row, float uRow, float vRow, int xStart, int xEnd)
+    {
+        for (int x = xStart; x < xEnd; ++x)
+        {
+            int k = sampleCoverage(sprite, sprite.dudx * (float)x + uRow, sprite.dvdx * (float)x + vRow);
+
+            if (k > 0)
+                blendPixel(row[x], sprite.colour, sprite.colourAlpha, k);
+        }
+    }
+
+    // A stamp is only translated, so every pixel uses the same four weights.
+    // Integer maths throughout, which the SIMD versions match exactly.
+    forcedinline int sampleStamp(const Sprite& sprite, const juce::uint8* top, const juce::uint8* bottom)
+    {
+        int coverage = (sprite.weights[0] * top[0] + sprite.weights[1] * top[1]
+                         + sprite.weights[2] * bottom[0] + sprite.weights[3] * bottom[1] + 128) >> 8;
+
+        return coverage + (coverage >> 7);
+    }
+
+    void stampRowScalar(const Sprite& sprite, const juce::uint8* top, const juce::uint8* bottom,
+                        juce::uint32* row, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            int k = sampleStamp(sprite, top + i, bottom + i);
+
+            if (k > 0)
+                blendPixel(row[i], sprite.colour, sprite.colourAlpha, k);
+        }
+    }
+
+   #if GLOWCOMPOSITOR_SSE
+    // Blends four pixels; k16 holds their 0..256 factors in its low four 16-bit lanes
+    forcedinline void blendFourSSE2(juce::uint32* row, __m128i k16, __m128i colour, __m128i colourAlpha)
+    {
+        const __m128i zeroi = _mm_setzero_si128();
+
+        // Factors as 16-bit lanes, each repeated for the 4 bytes of its pixel
+        __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(256), _mm_srli_epi16(_mm_mullo_epi16(k16, colourAlpha), 8));
+        __m128i kPairs = _mm_unpacklo_epi16(k16, k16);
+        __m128i inversePairs = _mm_unpacklo_epi16(inverse, inverse);
+
+        __m128i dest = _mm_loadu_si128((const __m128i*)row);
+        __m128i lo = _mm_unpacklo_epi8(dest, zeroi);
+        __m128i hi = _mm_unpackhi_epi8(dest, zeroi);
+
+        lo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(colour, _mm_unpacklo_epi32(kPairs, kPairs)), 8),
+                           _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_unpacklo_epi32(inversePairs, inversePairs)), 8));
+        hi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(colour, _mm_unpackhi_epi32(kPairs, kPairs)), 8),
+                           _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_unpackhi_epi32(inversePairs, inversePairs)), 8));
+
+        _mm_storeu_si128((__m128i*)row, _mm_packus_epi16(lo, hi));
+    }
+
+    // Four pixels per step; SSE2 has no gather, so the taps are scalar loads
+    void compositeRowSSE2(const Sprite& sprite, juce::uint32* row, float uRow, float vRow, int xStart, int xEnd)
+    {
+        const __m128 steps = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 dudx = _mm_set1_ps(sprite.dudx), dvdx = _mm_set1_ps(sprite.dvdx);
+        const __m128 uStart = _mm_set1_ps(uRow), vStart = _mm_set1_ps(vRow);
+        const __m128 maxU = _mm_set1_ps(sprite.maxU), maxV = _mm_set1_ps(sprite.maxV);
+        const __m128 stride = _mm_set1_ps((float)sprite.stride);
+        const __m128 toFactor = _mm_set1_ps(256.0f / 255.0f), half = _mm_set1_ps(0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128i zeroi = _mm_setzero_si128();
+        const __m128i colour = _mm_unpacklo_epi8(_mm_set1_epi32((int)sprite.colour), zeroi);
+        const __m128i colourAlpha = _mm_set1_epi16((short)sprite.colourAlpha);
+        const juce::uint8* mask = sprite.mask;
+        const int lineStride = sprite.stride;
+
+        int x = xStart;
+
+        for (; x + 4 <= xEnd; x += 4)
+        {
+            __m128 xs = _mm_add_ps(_mm_set1_ps((float)x), steps);
+            __m128 u = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(xs, dudx), uStart), zero), maxU);
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(xs, dvdx), vStart), zero), maxV);
+
+            // Positive, so truncation is floor
+            __m128i ix = _mm_cvttps_epi32(u);
+            __m128i iy = _mm_cvttps_epi32(v);
+            __m128 fx = _mm_sub_ps(u, _mm_cvtepi32_ps(ix));
+            __m128 fy = _mm_sub_ps(v, _mm_cvtepi32_ps(iy));
+
+            // No 32-bit multiply in SSE2; the offsets are exact in float
+            alignas(16) int offsets[4];
+            _mm_store_si128((__m128i*)offsets, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(iy), stride),
+                                                                          _mm_cvtepi32_ps(ix))));
+
+            const juce::uint8* p0 = mask + offsets[0];
+            const juce::uint8* p1 = mask + offsets[1];
+            const juce::uint8* p2 = mask + offsets[2];
+            const juce::uint8* p3 = mask + offsets[3];
+
+            __m128 p00 = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+            __m128 p01 = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+            __m128 p10 = _mm_setr_ps(p0[lineStride], p1[lineStride], p2[lineStride], p3[lineStride]);
+            __m128 p11 = _mm_setr_ps(p0[lineStride + 1], p1[lineStride + 1], p2[lineStride + 1], p3[lineStride + 1]);
+
+            __m128 top = _mm_add_ps(p00, _mm_mul_ps(_mm_sub_ps(p01, p00), fx));
+            __m128 bottom = _mm_add_ps(p10, _mm_mul_ps(_mm_sub_ps(p11, p10), fx));
+            __m128 sample = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fy));
+            __m128i k = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(sample, toFactor), half));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(k, zeroi)) == 0xffff)
+                continue;
+
+            blendFourSSE2(row + x, _mm_packs_epi32(k, k), colour, colourAlpha);
+        }
+
+        compositeRowScalar(sprite, row, uRow, vRow, x, xEnd);
+    }
+
+    // Eight pixels per step from plain loads; also used on AVX2 machines,
+    // where there's nothing left for gathers to speed up
+    void stampRowSSE2(const Sprite& sprite, const juce::uint8* top, const juce::uint8* bottom,
+                      juce::uint32* row, int count)
+    {
+        const __m128i zeroi = _mm_setzero_si128();
+        const __m128i topLeft = _mm_set1_epi16((short)sprite.weights[0]);
+        const __m128i topRight = _mm_set1_epi16((short)sprite.weights[1]);
+        const __m128i bottomLeft = _mm_set1_epi16((short)sprite.weights[2]);
+        const __m128i bottomRight = _mm_set1_epi16((short)sprite.weights[3]);
+        const __m128i colour = _mm_unpacklo_epi8(_mm_set1_epi32((int)sprite.colour), zeroi);
+        const __m128i colourAlpha = _mm_set1_epi16((short)sprite.colourAlpha);
+        const __m128i half = _mm_set1_epi16(128);
+
+        int i = 0;
+
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i t0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(top + i)), zeroi);
+            __m128i t1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(top + i + 1)), zeroi);
+            __m128i b0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(bottom + i)), zeroi);
+            __m128i b1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(bottom + i + 1)), zeroi);
+
+            // The weights sum to 256, so the total fits in 16 bits unsigned
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(t0, topLeft), _mm_mullo_epi16(t1, topRight)),
+                                        _mm_add_epi16(_mm_mullo_epi16(b0, bottomLeft), _mm_mullo_epi16(b1, bottomRight)));
+            sum = _mm_add_epi16(sum, half);
+            __m128i coverage = _mm_srli_epi16(sum, 8);
+            __m128i k = _mm_add_epi16(coverage, _mm_srli_epi16(coverage, 7));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(k, zeroi)) == 0xffff)
+                continue;
+
+            blendFourSSE2(row + i, k, colour, colourAlpha);
+            blendFourSSE2(row + i + 4, _mm_srli_si128(k, 8), colour, colourAlpha);
+        }
+
+        stampRowScalar(sprite, top + i, bottom + i, row + i, count - i);
+    }
+
+    // Eight pixels per step, taps fetched with gathers. Each gather reads 4
+    // bytes, which is what the 4 pixels of right padding are for.
+    GLOWCOMPOSITOR_AVX2_FUNCTION
+    void compositeRowAVX2(const Sprite& sprite, juce::uint32* row, float uRow, float vRow, int xStart, int xEnd)
+    {
+        const __m256 steps = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256 dudx = _mm256_set1_ps(sprite.dudx), dvdx = _mm256_set1_ps(sprite.dvdx);
+        const __m256 uStart = _mm256_set1_ps(uRow), vStart = _mm256_set1_ps(vRow);
+        const __m256 maxU = _mm256_set1_ps(sprite.maxU), maxV = _mm256_set1_ps(sprite.maxV);
+        const __m256i stride = _mm256_set1_epi32(sprite.stride);
+        const __m256 toFactor = _mm256_set1_ps(256.0f / 255.0f), half = _mm256_set1_ps(0.5f);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256i zeroi = _mm256_setzero_si256();
+        const __m256i byteMask = _mm256_set1_epi32(0xff);
+        const __m256i colour = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)sprite.colour), zeroi);
+        const __m256i colourAlpha = _mm256_set1_epi16((short)sprite.colourAlpha);
+        const __m256i full = _mm256_set1_epi16(256);
+        const int* topRow = (const int*)sprite.mask;
+        const int* bottomRow = (const int*)(sprite.mask + sprite.stride);
+
+        int x = xStart;
+
+        for (; x + 8 <= xEnd; x += 8)
+        {
+            __m256 xs = _mm256_add_ps(_mm256_set1_ps((float)x), steps);
+            __m256 u = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(xs, dudx), uStart), zero), maxU);
+            __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(xs, dvdx), vStart), zero), maxV);
+
+            __m256i ix = _mm256_cvttps_epi32(u);
+            __m256i iy = _mm256_cvttps_epi32(v);
+            __m256 fx = _mm256_sub_ps(u, _mm256_cvtepi32_ps(ix));
+            __m256 fy = _mm256_sub_ps(v, _mm256_cvtepi32_ps(iy));
+            __m256i offsets = _mm256_add_epi32(_mm256_mullo_epi32(iy, stride), ix);
+
+            // Low byte is the tap, the next one its right-hand neighbour
+            __m256i topTaps = _mm256_i32gather_epi32(topRow, offsets, 1);
+            __m256i bottomTaps = _mm256_i32gather_epi32(bottomRow, offsets, 1);
+
+            __m256 p00 = _mm256_cvtepi32_ps(_mm256_and_si256(topTaps, byteMask));
+            __m256 p01 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(topTaps, 8), byteMask));
+            __m256 p10 = _mm256_cvtepi32_ps(_mm256_and_si256(bottomTaps, byteMask));
+            __m256 p11 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(bottomTaps, 8), byteMask));
+
+            // Separate multiplies and adds (no FMA), and + 0.5 then truncate
+            // rather than round to even, to round like the scalar path
+            __m256 top = _mm256_add_ps(p00, _mm256_mul_ps(_mm256_sub_ps(p01, p00), fx));
+            __m256 bottom = _mm256_add_ps(p10, _mm256_mul_ps(_mm256_sub_ps(p11, p10), fx));
+            __m256 sample = _mm256_add_ps(top, _mm256_mul_ps(_mm256_sub_ps(bottom, top), fy));
+            __m256i k = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(sample, toFactor), half));
+
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(k, zeroi)) == -1)
+                continue;
+
+            // Same lane shuffles as SSE2; they stay within each 128-bit half,
+            // which matches how unpacklo/hi_epi8 split the destination
+            __m256i k16 = _mm256_packs_epi32(k, k);
+            __m256i inverse = _mm256_sub_epi16(full, _mm256_srli_epi16(_mm256_mullo_epi16(k16, colourAlpha), 8));
+            __m256i kPairs = _mm256_unpacklo_epi16(k16, k16);
+            __m256i inversePairs = _mm256_unpacklo_epi16(inverse, inverse);
+
+            __m256i dest = _mm256_loadu_si256((const __m256i*)(row + x));
+            __m256i lo = _mm256_unpacklo_epi8(dest, zeroi);
+            __m256i hi = _mm256_unpackhi_epi8(dest, zeroi);
+
+            lo = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(colour, _mm256_unpacklo_epi32(kPairs, kPairs)), 8),
+                                  _mm256_srli_epi16(_mm256_mullo_epi16(lo, _mm256_unpacklo_epi32(inversePairs, inversePairs)), 8));
+            hi = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(colour, _mm256_unpackhi_epi32(kPairs, kPairs)), 8),
+                                  _mm256_srli_epi16(_mm256_mullo_epi16(hi, _mm256_unpackhi_epi32(inversePairs, inversePairs)), 8));
+
+            _mm256_storeu_si256((__m256i*)(row + x), _mm256_packus_epi16(lo, hi));
+        }
+
+        compositeRowScalar(sprite, row, uRow, vRow, x, xEnd);
+    }
+   #endif
+
+   #if GLOWCOMPOSITOR_NEON
+    // Blends four pixels with the 0..256 factors k
+    forcedinline void blendFourNEON(juce::uint32* row, const int* k, uint16x8_t colour, int colourAlpha)
+    {
+        uint16_t inverse[4];
+        for (int i = 0; i < 4; ++i)
+            inverse[i] = (uint16_t)(256 - ((colourAlpha * k[i]) >> 8));
+
+        uint8x16_t dest = vld1q_u8((const uint8_t*)row);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(dest));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(dest));
+
+        uint16x8_t kLo = vcombine_u16(vdup_n_u16((uint16_t)k[0]), vdup_n_u16((uint16_t)k[1]));
+        uint16x8_t kHi = vcombine_u16(vdup_n_u16((uint16_t)k[2]), vdup_n_u16((uint16_t)k[3]));
+        uint16x8_t inverseLo = vcombine_u16(vdup_n_u16(inverse[0]), vdup_n_u16(inverse[1]));
+        uint16x8_t inverseHi = vcombine_u16(vdup_n_u16(inverse[2]), vdup_n_u16(inverse[3]));
+
+        lo = vaddq_u16(vshrq_n_u16(vmulq_u16(colour, kLo), 8), vshrq_n_u16(vmulq_u16(lo, inverseLo), 8));
+        hi = vaddq_u16(vshrq_n_u16(vmulq_u16(colour, kHi), 8), vshrq_n_u16(vmulq_u16(hi, inverseHi), 8));
+
+        vst1q_u8((uint8_t*)row, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+    }
+
+    void compositeRowNEON(const Sprite& sprite, juce::uint32* row, float uRow, float vRow, int xStart, int xEnd)
+    {
+        const float stepValues[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        const float32x4_t steps = vld1q_f32(stepValues);
+        const float32x4_t uStart = vdupq_n_f32(uRow), vStart = vdupq_n_f32(vRow);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t maxU = vdupq_n_f32(sprite.maxU), maxV = vdupq_n_f32(sprite.maxV);
+        const uint16x8_t colour = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(sprite.colour)));
+        const juce::uint8* mask = sprite.mask;
+        const int lineStride = sprite.stride;
+
+        int x = xStart;
+
+        for (; x + 4 <= xEnd; x += 4)
+        {
+            float32x4_t xs = vaddq_f32(vdupq_n_f32((float)x), steps);
+            float32x4_t u = vminq_f32(vmaxq_f32(vmlaq_n_f32(uStart, xs, sprite.dudx), zero), maxU);
+            float32x4_t v = vminq_f32(vmaxq_f32(vmlaq_n_f32(vStart, xs, sprite.dvdx), zero), maxV);
+
+            int32x4_t ix = vcvtq_s32_f32(u);
+            int32x4_t iy = vcvtq_s32_f32(v);
+            float32x4_t fx = vsubq_f32(u, vcvtq_f32_s32(ix));
+            float32x4_t fy = vsubq_f32(v, vcvtq_f32_s32(iy));
+
+            int offsets[4];
+            vst1q_s32(offsets, vmlaq_n_s32(ix, iy, lineStride));
+
+            float taps[4][4];
+            for (int i = 0; i < 4; ++i)
+            {
+                const juce::uint8* p = mask + offsets[i];
+                taps[0][i] = p[0];
+                taps[1][i] = p[1];
+                taps[2][i] = p[lineStride];
+                taps[3][i] = p[lineStride + 1];
+            }
+
+            float32x4_t p00 = vld1q_f32(taps[0]), p01 = vld1q_f32(taps[1]);
+            float32x4_t p10 = vld1q_f32(taps[2]), p11 = vld1q_f32(taps[3]);
+            float32x4_t top = vmlaq_f32(p00, vsubq_f32(p01, p00), fx);
+            float32x4_t bottom = vmlaq_f32(p10, vsubq_f32(p11, p10), fx);
+            float32x4_t sample = vmlaq_f32(top, vsubq_f32(bottom, top), fy);
+
+            int k[4];
+            vst1q_s32(k, vcvtq_s32_f32(vmlaq_n_f32(vdupq_n_f32(0.5f), sample, 256.0f / 255.0f)));
+
+            if ((k[0] | k[1] | k[2] | k[3]) == 0)
+                continue;
+
+            blendFourNEON(row + x, k, colour, sprite.colourAlpha);
+        }
+
+        compositeRowScalar(sprite, row, uRow, vRow, x, xEnd);
+    }
+
+    void stampRowNEON(const Sprite& sprite, const juce::uint8* top, const juce::uint8* bottom,
+                      juce::uint32* row, int count)
+    {
+        const uint16x8_t colour = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(sprite.colour)));
+
+        int i = 0;
+
+        for (; i + 8 <= count; i += 8)
+        {
+            // The weights sum to 256, so the total fits in 16 bits
+            uint16x8_t sum = vmlaq_n_u16(vdupq_n_u16(128), vmovl_u8(vld1_u8(top + i)), (uint16_t)sprite.weights[0]);
+            sum = vmlaq_n_u16(sum, vmovl_u8(vld1_u8(top + i + 1)), (uint16_t)sprite.weights[1]);
+            sum = vmlaq_n_u16(sum, vmovl_u8(vld1_u8(bottom + i)), (uint16_t)sprite.weights[2]);
+            sum = vmlaq_n_u16(sum, vmovl_u8(vld1_u8(bottom + i + 1)), (uint16_t)sprite.weights[3]);
+
+            uint16x8_t coverage = vshrq_n_u16(sum, 8);
+            uint16_t factors[8];
+            vst1q_u16(factors, vaddq_u16(coverage, vshrq_n_u16(coverage, 7)));
+
+            for (int half = 0; half < 8; half += 4)
+            {
+                int k[4] = { factors[half], factors[half + 1], factors[half + 2], factors[half + 3] };
+
+                if ((k[0] | k[1] | k[2] | k[3]) != 0)
+                    blendFourNEON(row + i + half, k, colour, sprite.colourAlpha);
+            }
+        }
+
+        stampRowScalar(sprite, top + i, bottom + i, row + i, count - i);
+    }
+   #endif
+
+    struct Kernel
+    {
+        RowFunction function;
+        StampRowFunction stampFunction;
+        const char* name;
+    };
+
+    const Kernel& getKernel()
+    {
+        static const Kernel kernel = []() -> Kernel
+        {
+           #if GLOWCOMPOSITOR_SSE
+            if (juce::SystemStats::hasAVX2())
+                return { compositeRowAVX2, stampRowSSE2, "AVX2" };
+
+            return { compositeRowSSE2, stampRowSSE2, "SSE2" };
+           #elif GLOWCOMPOSITOR_NEON
+            return { compositeRowNEON, stampRowNEON, "NEON" };
+           #else
+            return { compositeRowScalar, stampRowScalar, "scalar" };
+           #endif
+        }();
+
+        return kernel;
+    }
+
+    // Narrows [lo, hi] to the x where slope * x + intercept is within [0, limit]
+    void clipSpan(float slope, float intercept, float limit, float& lo, float& hi)
+    {
+        if (std::abs(slope) < 1.0e-6f)
+        {
+            if (intercept < 0.0f || intercept > limit)
+                hi = lo - 1.0f;
+
+            return;
+        }
+
+        float a = -intercept / slope;
+        float b = (limit - intercept) / slope;
+
+        lo = juce::jmax(lo, juce::jmin(a, b));
+        hi = juce::jmin(hi, juce::jmax(a, b));
+    }
+
+    bool setUpStamp(Sprite& sprite, juce::Rectangle<int>& bounds, const GlowCompositor::Layer& layer,
+                    juce::Rectangle<int> area)
+    {
+        auto& stamp = *layer.stamp;
+        float centreY = layer.stampFlipped ? (float)stamp.height - stamp.centre.y : stamp.centre.y;
+
+        // Frame pixel x samples the stamp at x + offset, between pixel centres
+        float offsetX = stamp.centre.x - layer.stampCentre.x;
+        float offsetY = centreY - layer.stampCentre.y;
+        int dx = (int)std::floor(offsetX);
+        int dy = (int)std::floor(offsetY);
+        int fx = juce::roundToInt((offsetX - (float)dx) * 256.0f);
+        int fy = juce::roundToInt((offsetY - (float)dy) * 256.0f);
+
+        if (fx == 256) { ++dx; fx = 0; }
+        if (fy == 256) { ++dy; fy = 0; }
+
+        // Rows and columns with a tap pair inside the stamp
+        bounds = juce::Rectangle<int>(-dx, -dy, stamp.width - 1, stamp.height - 1).getIntersection(area);
+
+        if (bounds.isEmpty())
+            return false;
+
+        auto pixel = layer.colour.getPixelARGB();
+        sprite.colour = pixel.getNativeARGB();
+        sprite.colourAlpha = pixel.getAlpha();
+        sprite.stamp = &stamp;
+        sprite.flipped = layer.stampFlipped;
+        sprite.stampDx = dx;
+        sprite.stampDy = dy;
+        sprite.weights[1] = (fx * (256 - fy) + 128) >> 8;
+        sprite.weights[2] = ((256 - fx) * fy + 128) >> 8;
+        sprite.weights[3] = (fx * fy + 128) >> 8;
+        sprite.weights[0] = juce::jmax(0, 256 - sprite.weights[1] - sprite.weights[2] - sprite.weights[3]);
+        sprite.weights[3] = 256 - sprite.weights[0] - sprite.weights[1] - sprite.weights[2];
+        return true;
+    }
+
+    // One frame's worth of tiles, handed out one at a time to whichever
+    // thread asks next, so busy tiles don't hold up a fixed share
+    struct TileWork
+    {
+        const Sprite* sprites;
+        const juce::Rectangle<int>* spriteBounds;
+        int numSprites;
+        const juce::Image::BitmapData* frame;
+        juce::Rectangle<int> area;
+        RowFunction compositeRow;
+        StampRowFunction stampRow;
+        int numTileColumns;
+        int numTiles;
+        std::atomic<int> nextTile { 0 };
+    };
+
+    void compositeStampRows(const TileWork& work, const Sprite& sprite, juce::Rectangle<int> region)
+    {
+        auto& stamp = *sprite.stamp;
+
+        for (int y = region.getY(); y < region.getBottom(); ++y)
+        {
+            // Taps come from this row of the (mirrored) stamp and the next
+            int row = y + sprite.stampDy;
+            int top = sprite.flipped ? stamp.height - 1 - row : row;
+            int bottom = sprite.flipped ? top - 1 : top + 1;
+
+            // Columns where either row is non-zero, and the pixel to their left
+            int lo = juce::jmin(stamp.rowStart[(size_t)top], stamp.rowStart[(size_t)bottom]) - 1;
+            int hi = juce::jmax(stamp.rowEnd[(size_t)top], stamp.rowEnd[(size_t)bottom]);
+            int xStart = juce::jmax(region.getX(), lo - sprite.stampDx);
+            int xEnd = juce::jmin(region.getRight(), hi - sprite.stampDx);
+
+            if (xStart >= xEnd)
+                continue;
+
+            int column = xStart + sprite.stampDx;
+            work.stampRow(sprite,
+                          stamp.pixels.data() + (stamp.rowOffset[(size_t)top] + column),
+                          stamp.pixels.data() + (stamp.rowOffset[(size_t)bottom] + column),
+                          (juce::uint32*)work.frame->getLinePointer(y) + xStart, xEnd - xStart);
+        }
+    }
+
+    void compositeTile(const TileWork& work, juce::Rectangle<int> tile)
+    {
+        for (int i = 0; i < work.numSprites; ++i)
+        {
+            auto& sprite = work.sprites[i];
+            auto region = work.spriteBounds[i].getIntersection(tile);
+
+            if (sprite.stamp != nullptr)
+            {
+                compositeStampRows(work, sprite, region);
+                continue;
+            }
+
+            for (int y = region.getY(); y < region.getBottom(); ++y)
+            {
+                float uRow = sprite.dudy * (float)y + sprite.u0;
+                float vRow = sprite.dvdy * (float)y + sprite.v0;
+
+                // Skip the parts of the row outside the (rotated) mask
+                float lo = (float)region.getX();
+                float hi = (float)region.getRight();
+                clipSpan(sprite.dudx, uRow, sprite.maxU, lo, hi);
+                clipSpan(sprite.dvdx, vRow, sprite.maxV, lo, hi);
+
+                int xStart = juce::jmax(region.getX(), (int)std::floor(lo) - 1);
+                int xEnd = juce::jmin(region.getRight(), (int)std::ceil(hi) + 1);
+
+                if (xStart < xEnd)
+                    work.compositeRow(sprite, (juce::uint32*)work.frame->getLinePointer(y), uRow, vRow, xStart, xEnd);
+            }
+        }
+    }
+
+    void compositeTiles(void* context)
+    {
+        auto& work = *static_cast<TileWork*>(context);
+
+        for (int index = work.nextTile++; index < work.numTiles; index = work.nextTile++)
+        {
+            int x = work.area.getX() + (index % work.numTileColumns) * GlowCompositor::tileSize;
+            int y = work.area.getY() + (index / work.numTileColumns) * GlowCompositor::tileSize;
+
+            compositeTile(work, juce::Rectangle<int>(x, y, GlowCompositor::tileSize, GlowCompositor::tileSize)
+                                    .getIntersection(work.area));
+        }
+    }
+}
+
+//==============================================================================
+GlowCompositor::Mask GlowCompositor::Mask::fromImage(const juce::Image& mask)
+{
+    Mask result;
+
+    if (!mask.isValid())
+        return result;
+
+    result.width = mask.getWidth();
+    result.height = mask.getHeight();
+    result.padded = juce::Image(juce::Image::SingleChannel, result.width + 5, result.height + 2,
+                                true, juce::SoftwareImageType());
+
+    juce::Image::BitmapData source(mask, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dest(result.padded, juce::Image::BitmapData::readWrite);
+
+    for (int y = 0; y < result.height; ++y)
+    {
+        juce::uint8* destLine = dest.getPixelPointer(1, y + 1);
+
+        if (source.pixelFormat == juce::Image::SingleChannel)
+        {
+            std::memcpy(destLine, source.getLinePointer(y), (size_t)result.width);
+        }
+        else
+        {
+            for (int x = 0; x < result.width; ++x)
+                destLine[x] = source.getPixelColour(x, y).getAlpha();
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+size_t GlowCompositor::Stamp::getSizeInBytes() const
+{
+    return sizeof(Stamp) + pixels.size() + (rowStart.size() + rowEnd.size() + rowOffset.size()) * sizeof(int);
+}
+
+GlowCompositor::Stamp GlowCompositor::Stamp::render(const Mask& mask, const juce::AffineTransform& shape)
+{
+    Stamp stamp;
+
+    if (!mask.isValid())
+        return stamp;
+
+    // Extent with the bilinear fringe, plus a zero pixel all round so the
+    // blit never needs bounds checks
+    auto aboutCentre = juce::AffineTransform::translation(-0.5f * (float)mask.width, -0.5f * (float)mask.height)
+                           .followedBy(shape);
+    auto extent = juce::Rectangle<float>(0.0f, 0.0f, (float)mask.width, (float)mask.height)
+                      .transformedBy(aboutCentre).expanded(1.0f);
+
+    int left = (int)std::floor(extent.getX()) - 1;
+    int top = (int)std::floor(extent.getY()) - 1;
+    stamp.width = (int)std::ceil(extent.getRight()) + 1 - left;
+    stamp.height = (int)std::ceil(extent.getBottom()) + 1 - top;
+    stamp.centre = { (float)-left, (float)-top };
+
+    // Drawn in white, the frame's alpha is the coverage
+    juce::Image frame(juce::Image::ARGB, stamp.width, stamp.height, true, juce::SoftwareImageType());
+    juce::Image::BitmapData frameData(frame, juce::Image::BitmapData::readWrite);
+
+    Layer layer { &mask, aboutCentre.translated(stamp.centre), juce::Colours::white };
+    composite(&layer, 1, frameData, { stamp.width, stamp.height });
+
+    std::vector<juce::uint8> coverage((size_t)(stamp.width * stamp.height));
+    stamp.rowStart.assign((size_t)stamp.height, stamp.width);
+    stamp.rowEnd.assign((size_t)stamp.height, 0);
+
+    for (int y = 0; y < stamp.height; ++y)
+    {
+        auto* line = (const juce::PixelARGB*)frameData.getLinePointer(y);
+        auto* dest = coverage.data() + y * stamp.width;
+
+        for (int x = 0; x < stamp.width; ++x)
+        {
+            dest[x] = line[x].getAlpha();
+
+            if (dest[x] != 0)
+            {
+                stamp.rowStart[(size_t)y] = juce::jmin(stamp.rowStart[(size_t)y], x);
+                stamp.rowEnd[(size_t)y] = x + 1;
+            }
+        }
+    }
+
+    // Each row keeps what the blit can read from it: the non-zero columns of
+    // itself and both neighbours, one pixel wider on each side
+    std::vector<int> keepStart((size_t)stamp.height), keepEnd((size_t)stamp.height);
+    size_t total = 0;
+
+    for (int y = 0; y < stamp.height; ++y)
+    {
+        int start = stamp.width, end = 0;
+
+        for (int row = juce::jmax(0, y - 1); row <= juce::jmin(stamp.height - 1, y + 1); ++row)
+        {
+            start = juce::jmin(start, stamp.rowStart[(size_t)row]);
+            end = juce::jmax(end, stamp.rowEnd[(size_t)row]);
+        }
+
+        keepStart[(size_t)y] = juce::jmax(0, start - 1);
+        keepEnd[(size_t)y] = juce::jmax(keepStart[(size_t)y], juce::jmin(stamp.width, end + 1));
+        total += (size_t)(keepEnd[(size_t)y] - keepStart[(size_t)y]);
+    }
+
+    stamp.pixels.reserve(total);
+    stamp.rowOffset.resize((size_t)stamp.height);
+
+    for (int y = 0; y < stamp.height; ++y)
+    {
+        auto* line = coverage.data() + y * stamp.width;
+        stamp.rowOffset[(size_t)y] = (int)stamp.pixels.size() - keepStart[(size_t)y];
+        stamp.pixels.insert(stamp.pixels.end(), line + keepStart[(size_t)y], line + keepEnd[(size_t)y]);
+    }
+
+    return stamp;
+}
+
+bool GlowCompositor::canComposite(const juce::Image::BitmapData& frame)
+{
+    return frame.pixelFormat == juce::Image::ARGB && frame.pixelStride == 4;
+}
+
+const char* GlowCompositor::getInstructionSetName()
+{
+    return getKernel().name;
+}
+
+void GlowCompositor::composite(const Layer* layers, int numLayers,
+                               const juce::Image::BitmapData& frame, juce::Rectangle<int> area,
+                               WorkerPool* workers)
+{
+    jassert(canComposite(frame));
+
+    area = area.getIntersection({ frame.width, frame.height });
+    constexpr int maxLayers = 8;
+    jassert(numLayers <= maxLayers);
+
+    Sprite sprites[maxLayers];
+    juce::Rectangle<int> spriteBounds[maxLayers];
+    int numSprites = 0;
+
+    for (int i = 0; i < juce::jmin(numLayers, maxLayers); ++i)
+    {
+        auto& layer = layers[i];
+
+        if (layer.stamp != nullptr)
+        {
+            if (layer.stamp->isValid() && layer.colour.getAlpha() > 0
+                 && setUpStamp(sprites[numSprites], spriteBounds[numSprites], layer, area))
+                ++numSprites;
+
+            continue;
+        }
+
+        if (layer.mask == nullptr || !layer.mask->isValid() || layer.colour.getAlpha() == 0
+             || std::abs(layer.transform.getDeterminant()) < 1.0e-6f)
+            continue;
+
+        // Pixels the sprite can touch, with a pixel for the bilinear fringe
+        auto bounds = juce::Rectangle<float>(0.0f, 0.0f, (float)layer.mask->width, (float)layer.mask->height)
+                          .transformedBy(layer.transform).expanded(1.0f).getSmallestIntegerContainer()
+                          .getIntersection(area);
+
+        if (bounds.isEmpty())
+            continue;
+
+        juce::Image::BitmapData maskData(layer.mask->padded, juce::Image::BitmapData::readOnly);
+        auto inverse = layer.transform.inverted();
+        auto pixel = layer.colour.getPixelARGB();
+
+        // Frame pixel centres, mask texel centres, plus the one-pixel border
+        auto& sprite = sprites[numSprites];
+        sprite.mask = maskData.data;
+        sprite.stride = maskData.lineStride;
+        sprite.maxU = (float)layer.mask->width + 1.0f - 1.0f / 1024.0f;
+        sprite.maxV = (float)layer.mask->height + 1.0f - 1.0f / 1024.0f;
+        sprite.dudx = inverse.mat00;
+        sprite.dudy = inverse.mat01;
+        sprite.u0 = 0.5f * (inverse.mat00 + inverse.mat01) + inverse.mat02 + 0.5f;
+        sprite.dvdx = inverse.mat10;
+        sprite.dvdy = inverse.mat11;
+        sprite.v0 = 0.5f * (inverse.mat10 + inverse.mat11) + inverse.mat12 + 0.5f;
+        sprite.colour = pixel.getNativeARGB();
+        sprite.colourAlpha = pixel.getAlpha();
+        sprite.stamp = nullptr;
+        spriteBounds[numSprites] = bounds;
+        ++numSprites;
+    }
+
+    TileWork work;
+    work.sprites = sprites;
+    work.spriteBounds = spriteBounds;
+    work.numSprites = numSprites;
+    work.frame = &frame;
+    work.area = area;
+    work.compositeRow = getKernel().function;
+    work.stampRow = getKernel().stampFunction;
+    work.numTileColumns = (area.getWidth() + tileSize - 1) / tileSize;
+    work.numTiles = work.numTileColumns * ((area.getHeight() + tileSize - 1) / tileSize);
+
+    if (numSprites == 0 || work.numTiles == 0)
+        return;
+
+    if (workers != nullptr && work.numTiles > 1)
+        workers->run(work.numTiles - 1, compositeTiles, &work);
+    else
+        compositeTiles(&work);
+}
+
+//==============================================================================
+class GlowCompositor::WorkerPool::Helper : public juce::ThreadPoolJob
+{
+public:
+    explicit Helper(WorkerPool& ownerToUse)
+        : juce::ThreadPoolJob("Glow tiles"), owner(ownerToUse) {}
+
+    JobStatus runJob() override
+    {
+        owner.runHelper();
+        return jobHasFinished;
+    }
+
+private:
+    WorkerPool& owner;
+};
+
+GlowCompositor::WorkerPool::WorkerPool()
+    : numWorkers(juce::jlimit(0, 7, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+GlowCompositor::WorkerPool::~WorkerPool()
+{
+    if (threadPool != nullptr)
+        threadPool->removeAllJobs(true, 1000);
+}
+
+void GlowCompositor::WorkerPool::run(int maxHelpers, void (*work)(void*), void* context)
+{
+    // Only one frame at a time; the helpers share these fields
+    jassert(state.load() == closedFlag);
+
+    int numHelpers = juce::jmin(maxHelpers, numWorkers);
+
+    if (numHelpers > 0 && threadPool == nullptr)
+    {
+        // Started on first use, so editors that never composite in parallel
+        // don't keep idle threads around
+        threadPool = std::make_unique<juce::ThreadPool>(numWorkers, 0, juce::Thread::Priority::high);
+
+        for (int i = 0; i < numWorkers; ++i)
+            helpers.add(new Helper(*this));
+    }
+
+    currentWork = work;
+    currentContext = context;
+    state.store(0);
+
+    // A helper still queued from an earlier frame just joins this one
+    for (int i = 0; i < numHelpers; ++i)
+        if (!threadPool->contains(helpers[i]))
+            threadPool->addJob(helpers[i], false);
+
+    work(context);
+
+    // No helper may start after this; wait for the ones still finishing a tile
+    state.fetch_or(closedFlag);
+
+    while (state.load() != closedFlag)
+        std::this_thread::yield();
+}
+
+void GlowCompositor::WorkerPool::runHelper()
+{
+    int current = state.load();
+
+    do
+    {
+        if ((current & closedFlag) != 0)
+            return;     // Turned up after the frame was finished
+    }
+    while (!state.compare_exchange_weak(current, current + 1));
+
+    currentWork(currentContext);
+    state.fetch_sub(1);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Software compositor for the glow: tinted alpha masks under an affine
+// transform (stretch, rotation, offset), blended into a premultiplied ARGB
+// frame. It does what drawImageTransformed(mask, transform, true) does with
+// bilinear filtering, but only for this one case, so it can skip the generic
+// renderer's per-pixel dispatch: each row works out the span the sprite
+// covers and runs an SSE2/AVX2/NEON kernel over it, and the frame is
+// processed in tiles with every layer applied before moving on, so the
+// destination stays in cache.
+class GlowCompositor
+{
+public:
+    // A SingleChannel mask copied with a zero border - one pixel, four on the
+    // right - so the kernels can sample and gather without bounds checks
+    struct Mask
+    {
+        juce::Image padded;
+        int width = 0;          // Of the original mask
+        int height = 0;
+
+        bool isValid() const { return padded.isValid(); }
+        static Mask fromImage(const juce::Image& mask);
+    };
+
+    // A mask already stretched and rotated into frame pixels (see
+    // GlowSpriteAtlas), so placing it only takes a translation. Rows are
+    // packed: each keeps just the columns the bilinear blit can read.
+    struct Stamp
+    {
+        int width = 0;                      // Including a zero border all round
+        int height = 0;
+        juce::Point<float> centre;          // Where the mask's centre ended up
+
+        std::vector<int> rowStart, rowEnd;  // Non-zero columns of each row (start == width if none)
+        std::vector<int> rowOffset;         // Index into pixels of each row's column 0
+        std::vector<juce::uint8> pixels;
+
+        bool isValid() const { return width > 0; }
+        size_t getSizeInBytes() const;
+
+        // Renders mask through shape, a linear transform about the mask's centre
+        static Stamp render(const Mask& mask, const juce::AffineTransform& shape);
+    };
+
+    struct Layer
+    {
+        const Mask* mask;
+        juce::AffineTransform transform;    // Original mask pixels to frame pixels
+        juce::Colour colour;                // Tint; its alpha is the layer opacity
+
+        // When set, drawn instead of mask: the stamp's centre goes to
+        // stampCentre (frame pixels), optionally mirrored top to bottom
+        const Stamp* stamp = nullptr;
+        juce::Point<float> stampCentre;
+        bool stampFlipped = false;
+    };
+
+    static constexpr int tileSize = 64;
+
+    // Threads that composite() can spread tiles over, shared through
+    // juce::SharedResourcePointer. The calling thread always works too, and
+    // composite() only returns once every tile is done, so the frame is
+    // complete when the caller blits it. One composite() at a time.
+    class WorkerPool
+    {
+    public:
+        WorkerPool();
+        ~WorkerPool();
+
+        int getNumWorkers() const { return numWorkers; }
+
+        // Runs work(context) on the calling thread and up to maxHelpers
+        // workers; work must share itself out and be safe to call concurrently
+        void run(int maxHelpers, void (*work)(void*), void* context);
+
+    private:
+        class Helper;
+
+        void runHelper();
+
+        // Count of helpers inside work(), plus this flag once the caller is done
+        static constexpr int closedFlag = 1 << 30;
+        std::atomic<int> state { closedFlag };
+
+        void (*currentWork)(void*) = nullptr;
+        void* currentContext = nullptr;
+
+        const int numWorkers;
+        juce::OwnedArray<Helper> helpers;
+        std::unique_ptr<juce::ThreadPool> threadPool;     // Declared last, stopped first
+
+        JUCE_DECLARE_NON_COPYABLE(WorkerPool)
+    };
+
+    // Composites layers (back to front) into the frame, touching only area.
+    // With workers, the tiles are split across them.
+    static void composite(const Layer* layers, int numLayers,
+                          const juce::Image::BitmapData& frame, juce::Rectangle<int> area,
+                          WorkerPool* workers = nullptr);
+
+    // Whether composite() can write into this frame; otherwise draw with JUCE
+    static bool canComposite(const juce::Image::BitmapData& frame);
+
+    // Kernel picked at runtime, e.g. "AVX2"
+    static const char* getInstructionSetName();
+};
@@ -0,0 +1,73 @@
+#include "GlowImageCache.h"
+#include "ProceduralGlow.h"
+#include <cstring>
+
+#if XYCONTROL_EMBED_GLOW_MASKS
+ #include "GlowMaskFormat.h"
+ #include "BinaryData.h"
+#endif
+
+const GlowImageCache::LayerImages& GlowImageCache::getLayers(const char* maskSetName, const LayerSizes& sizes, float scale)
+{
+    return getEntry(maskSetName, sizes, scale).images;
+}
+
+const GlowImageCache::CompositorMasks& GlowImageCache::getCompositorMasks(const char* maskSetName, const LayerSizes& sizes, float scale)
+{
+    auto& entry = getEntry(maskSetName, sizes, scale);
+
+    if (!entry.compositorMasks[0].isValid())
+    {
+        for (size_t i = 0; i < entry.images.size(); ++i)
+            entry.compositorMasks[i] = GlowCompositor::Mask::fromImage(entry.images[i]);
+    }
+
+    return entry.compositorMasks;
+}
+
+GlowImageCache::Entry& GlowImageCache::getEntry(const char* maskSetName, const LayerSizes& sizes, float scale)
+{
+    for (auto* entry : entries)
+    {
+        if (std::strcmp(entry->maskSetName, maskSetName) == 0 && entry->scale == scale)
+            return *entry;
+    }
+
+    auto* entry = entries.add(new Entry());
+    entry->maskSetName = maskSetName;
+    entry->scale = scale;
+    entry->images = createMaskSet(maskSetName, sizes, scale);
+
+    return *entry;
+}
+
+GlowImageCache::LayerImages GlowImageCache::createMaskSet(const char* maskSetName, const LayerSizes& sizes, float scale)
+{
+    LayerImages images;
+
+    for (int i = 0; i < numLayers; ++i)
+    {
+       #if XYCONTROL_EMBED_GLOW_MASKS
+        // The embedded masks only exist at 1x; other scales are rendered
+        if (scale == 1.0f)
+        {
+            // Construct resource name: "glow_mask_standard_layer_0"
+            juce::String resourceName = juce::String("glow_mask_") + maskSetName + "_layer_" + juce::String(i);
+
+            // Packed at build time by PackGlowMasks - no decoding needed
+            int dataSize = 0;
+            const char* data = BinaryData::getNamedResource((resourceName + "_glowmask").toRawUTF8(), dataSize);
+
+            if (data != nullptr && dataSize > 0)
+                images[(size_t)i] = GlowMaskFormat::decode(data, (size_t)dataSize);
+        }
+       #else
+        juce::ignoreUnused(maskSetName);
+       #endif
+
+        if (!images[(size_t)i].isValid())
+            images[(size_t)i] = ProceduralGlow::renderMask(ProceduralGlow::getLayerSpec(i, sizes[(size_t)i]), scale);
+    }
+
+    return images;
+}
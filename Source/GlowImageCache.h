@@ -0,0 +1,50 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+#include <array>
+#include "GlowCompositor.h"
+
+// Glow masks, shared by all XY controls in the process through
+// juce::SharedResourcePointer. Layers are single-channel alpha masks that get
+// tinted when drawn, so one set serves every colour with the same sizes.
+// Each set is rendered (see ProceduralGlow) the first time it's asked for at
+// a given pixel scale and then handed out by reference, so juce::Image copies
+// in the components share one set of pixels and preset switches don't
+// allocate. Message thread only.
+class GlowImageCache
+{
+public:
+    static constexpr int numLayers = 5;
+    using LayerImages = std::array<juce::Image, numLayers>;
+    using LayerSizes = std::array<int, numLayers>;
+    using CompositorMasks = std::array<GlowCompositor::Mask, numLayers>;
+
+    GlowImageCache() = default;
+
+    // maskSetName identifies the sizes, e.g. "standard" - it's also the
+    // resource prefix when the masks are embedded. scale is physical pixels
+    // per logical pixel; the masks are that much bigger than sizes.
+    const LayerImages& getLayers(const char* maskSetName, const LayerSizes& sizes, float scale = 1.0f);
+
+    // The same masks padded for GlowCompositor, made the first time they're asked for
+    const CompositorMasks& getCompositorMasks(const char* maskSetName, const LayerSizes& sizes, float scale = 1.0f);
+
+private:
+    struct Entry
+    {
+        const char* maskSetName = nullptr;
+        float scale = 1.0f;
+        LayerImages images;
+        CompositorMasks compositorMasks;
+    };
+
+    Entry& getEntry(const char* maskSetName, const LayerSizes& sizes, float scale);
+
+    static LayerImages createMaskSet(const char* maskSetName, const LayerSizes& sizes, float scale);
+
+    // One per mask set and display scale seen so far - a handful at most.
+    // Owned individually so references stay valid as entries are added.
+    juce::OwnedArray<Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GlowImageCache)
+};
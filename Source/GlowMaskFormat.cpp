@@ -0,0 +1,80 @@
+#include "GlowMaskFormat.h"
+#include <cstring>
+
+juce::MemoryBlock GlowMaskFormat::encode(const juce::Image& image)
+{
+    auto mask = image.convertedToFormat(juce::Image::SingleChannel);
+    const int width = mask.getWidth();
+    const int height = mask.getHeight();
+
+    juce::MemoryOutputStream out((size_t)(headerSize + width * height));
+    out.write("GLWM", 4);
+    out.writeShort((short)currentVersion);
+    out.writeShort((short)alpha8);
+    out.writeInt(width);
+    out.writeInt(height);
+
+    juce::Image::BitmapData src(mask, juce::Image::BitmapData::readOnly);
+
+    for (int y = 0; y < height; ++y)
+    {
+        if (src.pixelStride == 1)
+        {
+            out.write(src.getLinePointer(y), (size_t)width);
+        }
+        else
+        {
+            for (int x = 0; x < width; ++x)
+                out.writeByte((char)*src.getPixelPointer(x, y));
+        }
+    }
+
+    return out.getMemoryBlock();
+}
+
+juce::Image GlowMaskFormat::decode(const void* data, size_t dataSize)
+{
+    if (data == nullptr || dataSize < (size_t)headerSize)
+        return {};
+
+    auto* bytes = static_cast<const juce::uint8*>(data);
+
+    if (std::memcmp(bytes, "GLWM", 4) != 0
+        || juce::ByteOrder::littleEndianShort(bytes + 4) != currentVersion
+        || juce::ByteOrder::littleEndianShort(bytes + 6) != alpha8)
+        return {};
+
+    const int width = (int)juce::ByteOrder::littleEndianInt(bytes + 8);
+    const int height = (int)juce::ByteOrder::littleEndianInt(bytes + 12);
+
+    if (width <= 0 || height <= 0 || dataSize < (size_t)headerSize + (size_t)width * (size_t)height)
+        return {};
+
+    juce::Image image(juce::Image::SingleChannel, width, height, false);
+    juce::Image::BitmapData dest(image, juce::Image::BitmapData::writeOnly);
+    auto* pixels = bytes + headerSize;
+
+    if (dest.pixelStride == 1 && dest.lineStride == width)
+    {
+        std::memcpy(dest.data, pixels, (size_t)width * (size_t)height);
+    }
+    else
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            auto* src = pixels + (size_t)y * (size_t)width;
+
+            if (dest.pixelStride == 1)
+            {
+                std::memcpy(dest.getLinePointer(y), src, (size_t)width);
+            }
+            else
+            {
+                for (int x = 0; x < width; ++x)
+                    *dest.getPixelPointer(x, y) = src[x];
+            }
+        }
+    }
+
+    return image;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+
+// Raw glow mask blob, produced at build time by PackGlowMasks so the plugin
+// never has to inflate a PNG. Layout (little-endian):
+//
+//   0   char[4]  "GLWM"
+//   4   uint16   version (1)
+//   6   uint16   pixel format (1 = 8-bit alpha)
+//   8   uint32   width
+//   12  uint32   height
+//   16  uint8    width * height alpha values, rows top to bottom, no padding
+class GlowMaskFormat
+{
+public:
+    static constexpr int headerSize = 16;
+    static constexpr int currentVersion = 1;
+    static constexpr int alpha8 = 1;
+
+    // Packs the alpha channel of any image
+    static juce::MemoryBlock encode(const juce::Image& image);
+
+    // Copies the blob's pixels straight into a SingleChannel image - one memcpy
+    // when the image rows aren't padded. Returns an invalid image if the data
+    // isn't a mask blob.
+    static juce::Image decode(const void* data, size_t dataSize);
+};
@@ -0,0 +1,260 @@
+#include "GlowSpriteAtlas.h"
+#include <algorithm>
+#include <cmath>
+
+// Error bounds, for a radial mask f(rho) with M = max |f'(rho) * rho| (times
+// the layer alpha, in 8-bit levels), drawn as an ellipse with axes a and b:
+//
+//   changing log(a) by d changes a pixel by at most M * d - the squash
+//   across the motion changes more slowly than the stretch along it
+//
+//   rotating by d changes a pixel by at most M * d * (a/b - b/a) / 2
+//
+// Snapping to the nearest bin is off by half a step at most, and each of the
+// two gets half the budget.
+
+GlowSpriteAtlas::GlowSpriteAtlas(const Masks& masksToUse, const CometShapes& shapesToUse,
+                                 const Settings& settingsToUse)
+    : juce::Thread("Glow sprite atlas"),
+      masks(masksToUse),
+      shapes(shapesToUse),
+      settings(settingsToUse)
+{
+    constexpr int maxStretchBins = 512;
+    constexpr int maxAngleBins = 2048;
+    const float budget = juce::jmax(0.5f, settings.errorBudget);
+
+    for (int i = 0; i < numLayers; ++i)
+    {
+        auto& shape = shapes[(size_t)i];
+        auto& bins = layerBins[(size_t)i];
+        float steepness = juce::jmax(1.0f, getSteepness(masks[(size_t)i]) * shape.alpha);
+        float maxLogStretch = std::log1p(shape.stretch);
+
+        int numStretchSteps = juce::jlimit(1, maxStretchBins, (int)std::ceil(maxLogStretch * steepness / budget));
+        bins.stretchStep = maxLogStretch / (float)numStretchSteps;
+
+        for (int s = 0; s <= numStretchSteps; ++s)
+        {
+            // Widest comet this bin stands in for
+            float scaleX = std::exp(juce::jmin(maxLogStretch, ((float)s + 0.5f) * bins.stretchStep));
+            float speedFactor = (scaleX - 1.0f) / shape.stretch;
+            float scaleY = 1.0f / (1.0f + speedFactor * shape.squash);
+            float spread = scaleX / scaleY - scaleY / scaleX;
+
+            int numAngleSteps = juce::jlimit(1, maxAngleBins,
+                                             (int)std::ceil(juce::MathConstants<float>::halfPi * steepness * spread
+                                                            / (2.0f * budget)));
+
+            bins.firstSlot.push_back(numSlots);
+            bins.numAngles.push_back(numAngleSteps + 1);
+            numSlots += numAngleSteps + 1;
+        }
+    }
+
+    slots.reset(new Slot[(size_t)numSlots]);
+    pending.ensureStorageAllocated(maxPending);
+
+    startThread(juce::Thread::Priority::low);
+}
+
+GlowSpriteAtlas::~GlowSpriteAtlas()
+{
+    stopThread(2000);
+
+    for (int i = 0; i < numSlots; ++i)
+        delete slots[(size_t)i].stamp.load();
+}
+
+bool GlowSpriteAtlas::matches(const Masks& otherMasks, const Settings& otherSettings) const
+{
+    for (size_t i = 0; i < masks.size(); ++i)
+        if (masks[i].padded != otherMasks[i].padded)
+            return false;
+
+    return settings == otherSettings;
+}
+
+float GlowSpriteAtlas::getSteepness(const GlowCompositor::Mask& mask)
+{
+    if (!mask.isValid())
+        return 0.0f;
+
+    // The masks are radial, so the middle row has the whole profile
+    juce::Image::BitmapData data(mask.padded, juce::Image::BitmapData::readOnly);
+    const juce::uint8* row = data.getPixelPointer(1, 1 + mask.height / 2);
+    float centre = 0.5f * (float)mask.width;
+    float steepness = 0.0f;
+
+    for (int x = 0; x + 1 < mask.width; ++x)
+    {
+        float rho = std::abs((float)x + 1.0f - centre);
+        steepness = juce::jmax(steepness, (float)std::abs(row[x + 1] - row[x]) * rho);
+    }
+
+    return steepness;
+}
+
+GlowSpriteAtlas::Slot& GlowSpriteAtlas::getSlot(const Request& r)
+{
+    return slots[(size_t)(layerBins[(size_t)r.layerIndex].firstSlot[(size_t)r.stretchBin] + r.angleBin)];
+}
+
+juce::AffineTransform GlowSpriteAtlas::getBinShape(const Request& r) const
+{
+    auto& shape = shapes[(size_t)r.layerIndex];
+    auto& bins = layerBins[(size_t)r.layerIndex];
+    int numAngles = bins.numAngles[(size_t)r.stretchBin];
+
+    float scaleX = std::exp((float)r.stretchBin * bins.stretchStep);
+    float speedFactor = (scaleX - 1.0f) / shape.stretch;
+    float scaleY = 1.0f / (1.0f + speedFactor * shape.squash);
+    float angle = juce::MathConstants<float>::halfPi * (float)r.angleBin / (float)(numAngles - 1);
+
+    // Same order as XYControlComponent::getLayerTransform()
+    return juce::AffineTransform::scale(scaleX, scaleY).followedBy(juce::AffineTransform::rotation(angle));
+}
+
+void GlowSpriteAtlas::beginFrame()
+{
+    ++frameCounter;
+
+    if (stampBytes.load() <= settings.memoryBudget)
+        return;
+
+    // Oldest first, down to 3/4 of the budget so this doesn't run every frame
+    evictionOrder.clear();
+
+    for (int i = 0; i < numSlots; ++i)
+        if (slots[(size_t)i].state.load() == ready)
+            evictionOrder.push_back(i);
+
+    std::sort(evictionOrder.begin(), evictionOrder.end(), [this](int a, int b)
+    {
+        return slots[(size_t)a].lastUsedFrame < slots[(size_t)b].lastUsedFrame;
+    });
+
+    for (int index : evictionOrder)
+    {
+        if (stampBytes.load() <= settings.memoryBudget / 4 * 3)
+            break;
+
+        auto& slot = slots[(size_t)index];
+        std::unique_ptr<GlowCompositor::Stamp> stamp(slot.stamp.exchange(nullptr));
+
+        stampBytes -= stamp->getSizeInBytes();
+        --numStamps;
+        slot.state = empty;
+    }
+}
+
+GlowSpriteAtlas::Match GlowSpriteAtlas::find(int layerIndex, float speedFactor, float angle)
+{
+    jassert(layerIndex >= 0 && layerIndex < numLayers);
+
+    auto& bins = layerBins[(size_t)layerIndex];
+    float logStretch = std::log1p(juce::jlimit(0.0f, 1.0f, speedFactor) * shapes[(size_t)layerIndex].stretch);
+
+    Request r;
+    r.layerIndex = layerIndex;
+    r.stretchBin = juce::jlimit(0, (int)bins.numAngles.size() - 1, juce::roundToInt(logStretch / bins.stretchStep));
+
+    // The glow is symmetric, so half a turn round it looks the same, and a
+    // mirror image top to bottom turns angle into -angle
+    constexpr float pi = juce::MathConstants<float>::pi;
+    float folded = std::fmod(angle, pi);
+    if (folded < 0.0f)
+        folded += pi;
+
+    Match match;
+    match.flipped = folded > 0.5f * pi;
+
+    if (match.flipped)
+        folded = pi - folded;
+
+    int numAngles = bins.numAngles[(size_t)r.stretchBin];
+    r.angleBin = juce::jlimit(0, numAngles - 1, juce::roundToInt(folded / (0.5f * pi) * (float)(numAngles - 1)));
+
+    auto& slot = getSlot(r);
+    slot.lastUsedFrame = frameCounter;
+    match.stamp = slot.stamp.load(std::memory_order_acquire);
+
+    if (match.stamp != nullptr)
+    {
+        ++hits;
+        return match;
+    }
+
+    ++misses;
+    request(r);
+    return match;
+}
+
+void GlowSpriteAtlas::request(const Request& r)
+{
+    auto& slot = getSlot(r);
+    int expected = empty;
+
+    if (!slot.state.compare_exchange_strong(expected, queued))
+        return;     // Already on its way
+
+    {
+        const juce::ScopedLock sl(pendingLock);
+
+        // Storage is reserved; when it's full the oldest requests are the
+        // ones the glow has moved on from
+        if (pending.size() >= maxPending)
+        {
+            getSlot(pending.getFirst()).state = empty;
+            pending.remove(0);
+        }
+
+        pending.add(r);
+    }
+
+    notify();
+}
+
+void GlowSpriteAtlas::run()
+{
+    while (!threadShouldExit())
+    {
+        Request r;
+
+        {
+            const juce::ScopedLock sl(pendingLock);
+
+            if (pending.isEmpty())
+                r.layerIndex = -1;
+            else
+                r = pending.removeAndReturn(pending.size() - 1);
+        }
+
+        if (r.layerIndex < 0)
+        {
+            wait(-1);
+            continue;
+        }
+
+        auto stamp = std::make_unique<GlowCompositor::Stamp>(
+            GlowCompositor::Stamp::render(masks[(size_t)r.layerIndex], getBinShape(r)));
+
+        stampBytes += stamp->getSizeInBytes();
+        ++numStamps;
+
+        auto& slot = getSlot(r);
+        slot.stamp.store(stamp.release(), std::memory_order_release);
+        slot.state = ready;
+    }
+}
+
+GlowSpriteAtlas::Stats GlowSpriteAtlas::getStats() const
+{
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.numBins = numSlots;
+    stats.numStamps = numStamps.load();
+    stats.stampBytes = stampBytes.load();
+    return stats;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include "GlowCompositor.h"
+
+// Comet-stretched glow layers, pre-rendered as GlowCompositor stamps over a
+// grid of stretch and angle bins, so drawing a moving layer is a translated
+// blit instead of a resample through an arbitrary transform.
+//
+// Stamps are rendered on a background thread the first time their bin is
+// asked for; until then find() comes back empty and the caller draws the
+// layer the usual way. The bins are spaced so that snapping to the nearest
+// one moves no pixel by more than the error budget.
+class GlowSpriteAtlas : private juce::Thread
+{
+public:
+    static constexpr int numLayers = 5;
+
+    // At speed factor s (0..1) a layer is scaled by 1 + s * stretch along its
+    // motion and 1 / (1 + s * squash) across it
+    struct CometShape
+    {
+        float stretch;
+        float squash;
+        float alpha;        // Strongest opacity it's drawn with, for the error estimate
+    };
+
+    struct Settings
+    {
+        float errorBudget = 16.0f;                      // Max change to a pixel, in 8-bit levels
+        size_t memoryBudget = 64 * 1024 * 1024;         // Least recently used stamps go past this
+
+        bool operator==(const Settings& other) const
+        {
+            return errorBudget == other.errorBudget && memoryBudget == other.memoryBudget;
+        }
+    };
+
+    using Masks = std::array<GlowCompositor::Mask, numLayers>;
+    using CometShapes = std::array<CometShape, numLayers>;
+
+    GlowSpriteAtlas(const Masks& masks, const CometShapes& shapes, const Settings& settings);
+    ~GlowSpriteAtlas() override;
+
+    // Whether this atlas was built for the same masks, so it can be kept
+    bool matches(const Masks& otherMasks, const Settings& otherSettings) const;
+
+    // Call before each frame's lookups. Frees stamps over the memory budget,
+    // none of which can still be in use by then.
+    void beginFrame();
+
+    struct Match
+    {
+        const GlowCompositor::Stamp* stamp = nullptr;   // Null while it's being rendered
+        bool flipped = false;                           // Draw mirrored top to bottom
+    };
+
+    // Stamp for the nearest bin to this layer's stretch and motion angle
+    Match find(int layerIndex, float speedFactor, float angle);
+
+    struct Stats
+    {
+        int64_t hits = 0;
+        int64_t misses = 0;
+        int numBins = 0;
+        int numStamps = 0;
+        size_t stampBytes = 0;
+    };
+
+    Stats getStats() const;
+
+private:
+    enum SlotState { empty, queued, ready };
+
+    struct Slot
+    {
+        std::atomic<GlowCompositor::Stamp*> stamp { nullptr };
+        std::atomic<int> state { empty };
+        juce::uint32 lastUsedFrame = 0;     // Message thread only
+    };
+
+    struct Request
+    {
+        int layerIndex, stretchBin, angleBin;
+    };
+
+    // Stretch bins are spaced evenly in log(scaleX); each has its own number
+    // of angle bins over a quarter turn, more the longer the comet
+    struct LayerBins
+    {
+        float stretchStep = 0.0f;
+        std::vector<int> firstSlot;
+        std::vector<int> numAngles;
+    };
+
+    void run() override;
+
+    Slot& getSlot(const Request& request);
+    void request(const Request& request);
+    juce::AffineTransform getBinShape(const Request& request) const;
+
+    static float getSteepness(const GlowCompositor::Mask& mask);
+
+    Masks masks;
+    CometShapes shapes;
+    Settings settings;
+
+    std::array<LayerBins, numLayers> layerBins;
+    std::unique_ptr<Slot[]> slots;
+    int numSlots = 0;
+
+    juce::CriticalSection pendingLock;
+    juce::Array<Request> pending;               // Newest last, and rendered first
+    static constexpr int maxPending = 256;
+
+    std::atomic<size_t> stampBytes { 0 };
+    std::atomic<int> numStamps { 0 };
+    juce::uint32 frameCounter = 0;
+    int64_t hits = 0, misses = 0;
+    std::vector<int> evictionOrder;
+
+    JUCE_DECLARE_NON_COPYABLE(GlowSpriteAtlas)
+};
@@ -14,10 +14,20 @@ MainComponent::MainComponent()
 
 MainComponent::~MainComponent()
 {
+    animationClock->removeClient(*this, *this);
 }
 
-void MainComponent::paint(juce::Graphics& g)
+void MainComponent::renderChrome(float scale)
 {
+    chromePreset = xyControl.getCurrentPreset();
+    chromeScale = scale;
+    chromeCache = juce::Image(juce::Image::RGB,
+                              juce::jmax(1, juce::roundToInt(getWidth() * scale)),
+                              juce::jmax(1, juce::roundToInt(getHeight() * scale)), false);
+
+    juce::Graphics g(chromeCache);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
     // Fill background
     g.fillAll(juce::Colour(0xfff5f5f7));
 
@@ -27,12 +37,11 @@ void MainComponent::paint(juce::Graphics& g)
     shadowPath.addRoundedRectangle(controlBounds.toFloat(), 24.0f);
 
     // Use lighter shadow for dark presets, darker shadow for light presets
-    auto preset = xyControl.getCurrentPreset();
     juce::Colour baseShadowColor;
 
-    if (preset == XYControlComponent::Preset::Blue)
+    if (chromePreset == XYControlComponent::Preset::Blue)
         baseShadowColor = juce::Colour(0x14000000);  // Dark shadow for white background
-    else if (preset == XYControlComponent::Preset::Red)
+    else if (chromePreset == XYControlComponent::Preset::Red)
         baseShadowColor = juce::Colour(0x30000000);  // Darker shadow for red
     else // Black
         baseShadowColor = juce::Colour(0x40000000);  // Even darker shadow for black
@@ -40,19 +49,60 @@ void MainComponent::paint(juce::Graphics& g)
     // Normal shadow always (doesn't grow)
     juce::DropShadow shadow(baseShadowColor, 16, juce::Point<int>(0, 4));
     shadow.drawForPath(g, shadowPath);
+}
+
+MainComponent::HoldRing MainComponent::getHoldRing() const
+{
+    // Use float directly for stroke and expansion - no casting
+    float strokeWidth = 2.0f + holdProgress * 4.0f;
+    float expansion = 6.0f + holdProgress * 24.0f;
+    float ringAlpha = 0.2f + holdProgress * 0.5f;
+
+    return { xyControl.getBounds().toFloat().expanded(expansion),
+             strokeWidth,
+             juce::Colour(0xff007aff).withAlpha(ringAlpha) };
+}
+
+juce::Rectangle<int> MainComponent::getHoldRingBounds() const
+{
+    if (holdProgress <= 0.0f)
+        return {};
+
+    // Half the stroke sits outside the rectangle, plus a pixel of anti-aliasing
+    auto ring = getHoldRing();
+    return ring.area.expanded(ring.strokeWidth * 0.5f + 1.0f).getSmallestIntegerContainer();
+}
+
+void MainComponent::repaintHoldRing()
+{
+    auto ringBounds = getHoldRingBounds();
+    juce::RectangleList<int> dirty(ringBounds.getUnion(lastHoldRingBounds));
+    lastHoldRingBounds = ringBounds;
+
+    // The ring goes around the XY control, never over it, so leave the control
+    // out - otherwise it would be repainted along with the ring every frame
+    dirty.subtract(xyControl.getBounds());
+
+    for (auto& area : dirty)
+        repaint(area);
+}
+
+void MainComponent::paint(juce::Graphics& g)
+{
+    // Static chrome comes from the cache, re-rendered only when it's stale
+    float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (!chromeCache.isValid() || scale != chromeScale || xyControl.getCurrentPreset() != chromePreset)
+        renderChrome(scale);
+
+    g.drawImageTransformed(chromeCache, juce::AffineTransform::scale(1.0f / chromeScale));
 
     if (holdProgress > 0.0f)
     {
         // Only animate the blue ring - keep it simple for smoothness
-        float ringAlpha = 0.2f + holdProgress * 0.5f;
-        g.setColour(juce::Colour(0xff007aff).withAlpha(ringAlpha));
-
-        // Use float directly for stroke and expansion - no casting
-        float strokeWidth = 2.0f + holdProgress * 4.0f;
-        float expansion = 6.0f + holdProgress * 24.0f;
-
-        g.drawRoundedRectangle(controlBounds.toFloat().expanded(expansion),
-                              28.0f, strokeWidth);
+        auto ring = getHoldRing();
+        g.setColour(ring.colour);
+        g.drawRoundedRectangle(ring.area, 28.0f, ring.strokeWidth);
     }
 }
 
@@ -62,6 +112,10 @@ void MainComponent::resized()
 
     // Make it 500x500 like the HTML version
     xyControl.setBounds(bounds.withSizeKeepingCentre(500, 500));
+
+    // Shadow moved with the control
+    chromeCache = {};
+    lastHoldRingBounds = {};
 }
 
 void MainComponent::mouseDown(const juce::MouseEvent& event)
@@ -70,10 +124,10 @@ void MainComponent::mouseDown(const juce::MouseEvent& event)
     if (!xyControl.getBounds().contains(event.getPosition()))
     {
         isHoldingOutside = true;
-        holdStartTime = juce::Time::currentTimeMillis();
+        holdStartTime = juce::Time::getMillisecondCounterHiRes();
         holdProgress = 0.0f;
         menuShown = false;
-        startTimerHz(60);  // Explicit 60Hz for smooth animation
+        animationClock->setFrameRate(*this, *this, 60);  // Explicit 60Hz for smooth animation
     }
 }
 
@@ -81,8 +135,8 @@ void MainComponent::mouseUp(const juce::MouseEvent& event)
 {
     isHoldingOutside = false;
     holdProgress = 0.0f;
-    stopTimer();
-    repaint();
+    animationClock->setFrameRate(*this, *this, 0);
+    repaintHoldRing();
 }
 
 void MainComponent::mouseDoubleClick(const juce::MouseEvent& event)
@@ -93,38 +147,49 @@ void MainComponent::mouseDoubleClick(const juce::MouseEvent& event)
         // Cycle to next preset
         auto currentPreset = static_cast<int>(xyControl.getCurrentPreset());
         currentPreset = (currentPreset + 1) % 3;  // 0->1->2->0
-        xyControl.setPreset(static_cast<XYControlComponent::Preset>(currentPreset));
+        applyPreset(static_cast<XYControlComponent::Preset>(currentPreset));
     }
 }
 
-void MainComponent::timerCallback()
+void MainComponent::advanceAnimation(double timeMs)
 {
     if (isHoldingOutside && !menuShown)
     {
-        int64_t currentTime = juce::Time::currentTimeMillis();
-        int64_t holdDuration = currentTime - holdStartTime;
+        double holdDuration = timeMs - holdStartTime;
 
         // Update hold progress for visual feedback - use float division for smoothness
         holdProgress = juce::jmin(1.0f, (float)holdDuration / 3000.0f);
 
-        // Force immediate repaint for smooth animation
-        repaint();
-
-        if (holdDuration >= 3000)  // 3 seconds
+        if (holdDuration >= 3000.0)  // 3 seconds
         {
             menuShown = true;
             holdProgress = 0.0f;
-            stopTimer();
-            repaint();
-
-            showPresetOptions();
+            animationClock->setFrameRate(*this, *this, 0);
+            repaintHoldRing();
+
+            // Not from inside the clock's tick, the dialogs may run a modal loop
+            juce::Component::SafePointer<MainComponent> safeThis(this);
+            juce::MessageManager::callAsync([safeThis]
+            {
+                if (safeThis != nullptr)
+                    safeThis->showPresetOptions();
+            });
         }
     }
-    else if (holdProgress > 0.0f)
-    {
-        // Continue animating even after release until fully reset
-        repaint();
-    }
+}
+
+void MainComponent::flushAnimation()
+{
+    // Only the strips the ring covers, not the whole window
+    repaintHoldRing();
+}
+
+void MainComponent::applyPreset(XYControlComponent::Preset preset)
+{
+    xyControl.setPreset(preset);
+
+    // The shadow colour follows the preset, and it's outside the control's bounds
+    repaint();
 }
 
 void MainComponent::showPresetOptions()
@@ -155,6 +220,9 @@ void MainComponent::savePresetToFile(const juce::File& file)
     obj->setProperty("preset_type", (int)xyControl.getCurrentPreset());
     obj->setProperty("name", file.getFileNameWithoutExtension());
 
+    if (onSavePreset)
+        onSavePreset(*obj);
+
     // Write to file
     juce::String jsonString = juce::JSON::toString(presetData, true);
     bool success = file.replaceWithText(jsonString);
@@ -181,7 +249,10 @@ void MainComponent::loadPresetFromFile(const juce::File& file)
         if (obj->hasProperty("preset_type"))
         {
             int presetType = obj->getProperty("preset_type");
-            xyControl.setPreset(static_cast<XYControlComponent::Preset>(presetType));
+            applyPreset(static_cast<XYControlComponent::Preset>(presetType));
+
+            if (onLoadPreset)
+                onLoadPreset(*obj);
 
             NativeDialogs::showConfirmation("Preset Loaded",
                                            "Loaded \"" + file.getFileNameWithoutExtension() + "\"",
@@ -329,7 +329,7 @@ private:
 };
 
 class MainComponent : public juce::Component,
-                      private juce::Timer
+                      private AnimationClock::Client
 {
 public:
     MainComponent();
@@ -341,20 +341,51 @@ public:
     void mouseUp(const juce::MouseEvent& event) override;
     void mouseDoubleClick(const juce::MouseEvent& event) override;
 
+    XYControlComponent& getXYControl() { return xyControl; }
+
+    // For whoever hosts the pad to keep its own data in presets: called with
+    // the preset's JSON object as it's saved, and as it's loaded
+    std::function<void(juce::DynamicObject&)> onSavePreset;
+    std::function<void(const juce::DynamicObject&)> onLoadPreset;
+
 private:
-    void timerCallback() override;
+    struct HoldRing
+    {
+        juce::Rectangle<float> area;
+        float strokeWidth;
+        juce::Colour colour;
+    };
+
+    void advanceAnimation(double timeMs) override;
+    void flushAnimation() override;
     void savePresetToFile(const juce::File& file);
     void loadPresetFromFile(const juce::File& file);
     void showPresetOptions();
+    void applyPreset(XYControlComponent::Preset preset);
+
+    void renderChrome(float scale);
+    HoldRing getHoldRing() const;
+    juce::Rectangle<int> getHoldRingBounds() const;
+    void repaintHoldRing();
 
     XYControlComponent xyControl;
 
     bool isHoldingOutside = false;
-    int64_t holdStartTime = 0;
+    double holdStartTime = 0.0;
     bool menuShown = false;
     float holdProgress = 0.0f;  // 0.0 to 1.0 for visual feedback
 
+    // Background and the XY control's drop shadow, rendered once per preset,
+    // size and pixel scale. Only the hold ring is drawn live on top.
+    juce::Image chromeCache;
+    XYControlComponent::Preset chromePreset = XYControlComponent::Preset::Blue;
+    float chromeScale = 0.0f;
+
+    // Where the ring was last drawn, so shrinking it clears the old pixels
+    juce::Rectangle<int> lastHoldRingBounds;
+
     juce::File presetsFolder;
+    juce::SharedResourcePointer<AnimationClock> animationClock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
@@ -2,14 +2,88 @@
 #include "PluginEditor.h"
 
 XYControlAudioProcessorEditor::XYControlAudioProcessorEditor(XYControlAudioProcessor& p)
-    : AudioProcessorEditor(&p), audioProcessor(p)
+    : AudioProcessorEditor(&p), audioProcessor(p),
+      xParameter(*p.parameters.getParameter(XYControlAudioProcessor::xParameterID.getParamID())),
+      yParameter(*p.parameters.getParameter(XYControlAudioProcessor::yParameterID.getParamID()))
 {
+    auto& xyControl = mainComponent.getXYControl();
+
+    // One gesture per drag, so the host records it as one automation move
+    xyControl.onDragStart = [this]
+    {
+        isDragging = true;
+        xParameter.beginChangeGesture();
+        yParameter.beginChangeGesture();
+    };
+
+    xyControl.onTargetChanged = [this](juce::Point<float> target)
+    {
+        knownX = target.x;
+        knownY = toPadY(target.y);
+        xParameter.setValueNotifyingHost(xParameter.convertTo0to1(knownX));
+        yParameter.setValueNotifyingHost(yParameter.convertTo0to1(knownY));
+    };
+
+    xyControl.onDragEnd = [this]
+    {
+        isDragging = false;
+        xParameter.endChangeGesture();
+        yParameter.endChangeGesture();
+    };
+
+    // The morph's corners travel with the pad's presets, as a list of
+    // values per corner
+    mainComponent.onSavePreset = [this](juce::DynamicObject& preset)
+    {
+        auto corners = audioProcessor.getMorphCorners();
+        auto* morph = new juce::DynamicObject();
+
+        for (int corner = 0; corner < XYMorph::numCorners; ++corner)
+        {
+            juce::Array<juce::var> values;
+
+            for (auto value : corners[(size_t)corner])
+                values.add(value);
+
+            morph->setProperty(XYControlAudioProcessor::getMorphCornerName(corner), values);
+        }
+
+        preset.setProperty("morph", juce::var(morph));
+    };
+
+    mainComponent.onLoadPreset = [this](const juce::DynamicObject& preset)
+    {
+        // Presets from before there were corners keep the ones there are
+        auto* morph = preset.getProperty("morph").getDynamicObject();
+
+        if (morph == nullptr)
+            return;
+
+        auto corners = audioProcessor.getMorphCorners();
+
+        for (int corner = 0; corner < XYMorph::numCorners; ++corner)
+            if (auto* values = morph->getProperty(XYControlAudioProcessor::getMorphCornerName(corner)).getArray())
+                for (int i = 0; i < juce::jmin(values->size(), XYControlAudioProcessor::numMorphParameters); ++i)
+                    corners[(size_t)corner][(size_t)i] = juce::jlimit(0.0f, 1.0f, (float)(*values)[i]);
+
+        audioProcessor.setMorphCorners(corners);
+    };
+
     addAndMakeVisible(mainComponent);
     setSize(700, 700);
+
+    animationClock->setFrameRate(*this, *this, parameterPollRateHz);
 }
 
 XYControlAudioProcessorEditor::~XYControlAudioProcessorEditor()
 {
+    animationClock->removeClient(*this, *this);
+
+    if (isDragging)
+    {
+        xParameter.endChangeGesture();
+        yParameter.endChangeGesture();
+    }
 }
 
 void XYControlAudioProcessorEditor::paint(juce::Graphics& g)
@@ -21,3 +95,33 @@ void XYControlAudioProcessorEditor::resized()
 {
     mainComponent.setBounds(getLocalBounds());
 }
+
+void XYControlAudioProcessorEditor::advanceAnimation(double)
+{
+    // While the user has hold of it the pad leads, and the host follows
+    if (isDragging)
+        return;
+
+    float x = xParameter.convertFrom0to1(xParameter.getValue());
+    float y = yParameter.convertFrom0to1(yParameter.getValue());
+
+    if (juce::exactlyEqual(x, knownX) && juce::exactlyEqual(y, knownY))
+        return;
+
+    knownX = x;
+    knownY = y;
+    mainComponent.getXYControl().setTarget({ x, toPadY(y) });
+}
+
+//==============================================================================
+// The processor's side of the editor lives here rather than in
+// PluginProcessor.cpp, so the processor builds without any of the UI
+bool XYControlAudioProcessor::hasEditor() const
+{
+    return true;
+}
+
+juce::AudioProcessorEditor* XYControlAudioProcessor::createEditor()
+{
+    return new XYControlAudioProcessorEditor(*this);
+}
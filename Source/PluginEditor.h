@@ -4,7 +4,8 @@
 #include "PluginProcessor.h"
 #include "MainComponent.h"
 
-class XYControlAudioProcessorEditor : public juce::AudioProcessorEditor
+class XYControlAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                      private AnimationClock::Client
 {
 public:
     XYControlAudioProcessorEditor(XYControlAudioProcessor&);
@@ -14,8 +15,29 @@ public:
     void resized() override;
 
 private:
+    // Picks up host automation (and restored state) from the parameters on
+    // the shared clock, rather than listening: parameter callbacks can come
+    // on the audio thread, which mustn't touch the pad
+    void advanceAnimation(double timeMs) override;
+    void flushAnimation() override {}
+
+    // The pad's 0..1 target is top to bottom; the Y parameter is bottom to top
+    static float toPadY(float parameterY) { return 1.0f - parameterY; }
+
     XYControlAudioProcessor& audioProcessor;
     MainComponent mainComponent;
 
+    juce::RangedAudioParameter& xParameter;
+    juce::RangedAudioParameter& yParameter;
+
+    // Parameter values the pad is already at, whether it sent them or was
+    // moved to them, so a change is only applied once and never echoed back
+    float knownX = 0.5f;
+    float knownY = 0.5f;
+    bool isDragging = false;
+
+    static constexpr int parameterPollRateHz = 30;
+    juce::SharedResourcePointer<AnimationClock> animationClock;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(XYControlAudioProcessorEditor)
 };
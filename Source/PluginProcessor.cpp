@@ -1,15 +1,57 @@
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
 
 XYControlAudioProcessor::XYControlAudioProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
-                     .withOutput("Output", juce::AudioChannelSet::stereo(), true))
+                     .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+      parameters(*this, nullptr, "XYControl", createParameterLayout())
 {
+    xParameter = parameters.getRawParameterValue(xParameterID.getParamID());
+    yParameter = parameters.getRawParameterValue(yParameterID.getParamID());
+
+    // Real sizes come in prepareToPlay()
+    for (auto* buffer : { &modulationX, &modulationY, &targetRampX, &targetRampY })
+        buffer->resize(512);
+
+    for (int i = 0; i < numMorphParameters; ++i)
+        morphParameters[(size_t)i] = parameters.getParameter(getMorphParameterID(i).getParamID());
+
+    morph.setNumParameters(numMorphParameters);
+
+    // Out of the box each parameter has 0, 1/3, 2/3 and 1 on its corners,
+    // turned a corner further round than the last, so no two move alike
+    MorphCorners corners;
+
+    for (int corner = 0; corner < XYMorph::numCorners; ++corner)
+        for (int i = 0; i < numMorphParameters; ++i)
+            corners[(size_t)corner][(size_t)i] = (float)((corner + i) % XYMorph::numCorners) / 3.0f;
+
+    setMorphCorners(corners);
+
+    startTimerHz(morphNotifyRateHz);
 }
 
 XYControlAudioProcessor::~XYControlAudioProcessor()
 {
+    stopTimer();
+    endMorphGestures();
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout XYControlAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    // Centred, where the pad starts
+    layout.add(std::make_unique<juce::AudioParameterFloat>(xParameterID, "X", juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(yParameterID, "Y", juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f));
+
+    // Written by the pad, so the host records nothing of its own for them
+    for (int i = 0; i < numMorphParameters; ++i)
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getMorphParameterID(i), "Morph " + juce::String(i + 1),
+                                                               juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f,
+                                                               juce::AudioParameterFloatAttributes().withAutomatable(false)));
+
+    return layout;
 }
 
 const juce::String XYControlAudioProcessor::getName() const
@@ -65,7 +107,20 @@ void XYControlAudioProcessor::changeProgramName(int index, const juce::String& n
 
 void XYControlAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    juce::ignoreUnused(sampleRate, samplesPerBlock);
+    blockTargetX = xParameter->load();
+    blockTargetY = yParameter->load();
+
+    modulator.prepare(sampleRate);
+    modulator.reset({ blockTargetX, blockTargetY });
+
+    for (auto* buffer : { &modulationX, &modulationY, &targetRampX, &targetRampY })
+        buffer->assign((size_t)juce::jmax(1, samplesPerBlock), 0.0f);
+
+    effect.prepare(sampleRate, (int)modulationX.size());
+    effect.reset(blockTargetX, blockTargetY);
+
+    // Whatever the host did with them while stopped, send them all again
+    morph.resync();
 }
 
 void XYControlAudioProcessor::releaseResources()
@@ -89,32 +144,215 @@ void XYControlAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juc
     juce::ignoreUnused(midiMessages);
     juce::ScopedNoDenormals noDenormals;
 
-    // Pass-through audio
+    // Two relaxed loads: no locks, no allocations, whatever the editor or
+    // host is doing to them meanwhile
+    auto targetX = xParameter->load(std::memory_order_relaxed);
+    auto targetY = yParameter->load(std::memory_order_relaxed);
+
+    auto numSamples = buffer.getNumSamples();
+    auto maxChunk = (int)modulationX.size();
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
+        buffer.clear(i, 0, numSamples);
+
+    auto numChannels = juce::jmin(2, totalNumInputChannels, buffer.getNumChannels());
+
+    // Most blocks nothing's moved, and the target just stays put
+    bool isRamping = !juce::exactlyEqual(targetX, blockTargetX) || !juce::exactlyEqual(targetY, blockTargetY);
+    auto rampFromX = blockTargetX;
+    auto rampFromY = blockTargetY;
+
+    // Where the spring got to by the end of the block
+    auto endX = blockTargetX;
+    auto endY = blockTargetY;
+
+    for (int start = 0; start < numSamples; start += maxChunk)
+    {
+        auto chunk = juce::jmin(maxChunk, numSamples - start);
+
+        if (isRamping)
+        {
+            // Longer blocks than promised come in pieces of the same ramp
+            auto end = start + chunk;
+            auto along = (float)end / (float)numSamples;
+            auto rampToX = end == numSamples ? targetX : blockTargetX + (targetX - blockTargetX) * along;
+            auto rampToY = end == numSamples ? targetY : blockTargetY + (targetY - blockTargetY) * along;
+
+            XYModulator::fillRamp(targetRampX.data(), rampFromX, rampToX, chunk);
+            XYModulator::fillRamp(targetRampY.data(), rampFromY, rampToY, chunk);
+            rampFromX = rampToX;
+            rampFromY = rampToY;
+
+            modulator.process(targetRampX.data(), targetRampY.data(), modulationX.data(), modulationY.data(), chunk);
+        }
+        else
+        {
+            modulator.process(modulationX.data(), modulationY.data(), chunk);
+        }
+
+        endX = modulationX[(size_t)chunk - 1];
+        endY = modulationY[(size_t)chunk - 1];
+
+        if (numChannels > 0)
+        {
+            float* channels[] = { buffer.getWritePointer(0, start),
+                                  buffer.getWritePointer(numChannels - 1, start) };
+            effect.process(channels, numChannels, chunk, modulationX.data(), modulationY.data());
+        }
+    }
+
+    blockTargetX = targetX;
+    blockTargetY = targetY;
+
+    // Once a block is as often as a host takes parameter changes anyway
+    if (numSamples > 0)
+        updateMorph(endX, endY);
 }
 
-bool XYControlAudioProcessor::hasEditor() const
+void XYControlAudioProcessor::updateMorph(float x, float y)
 {
-    return true;
+    if (pendingMorphCorners.acquire())
+    {
+        auto& corners = pendingMorphCorners.getReadBuffer();
+
+        for (int corner = 0; corner < XYMorph::numCorners; ++corner)
+            morph.setCorner(corner, corners[(size_t)corner].data());
+
+        // New corners usually come with restored state, which has its own
+        // idea of the parameters' values
+        morph.resync();
+    }
+
+    // Only what's moved goes to the host, not all of them every block. The
+    // host can lock when told, so that's left to the message thread.
+    auto numChanges = morph.process(x, y);
+    auto* changes = morph.getChanges();
+    auto* values = morph.getValues();
+
+    for (int i = 0; i < numChanges; ++i)
+    {
+        auto index = (size_t)changes[i];
+        morphValues[index].store(values[index], std::memory_order_relaxed);
+        morphValueChanged[index].store(true, std::memory_order_release);
+    }
+}
+
+void XYControlAudioProcessor::timerCallback()
+{
+    bool anyChanged = false;
+
+    // Changed again meanwhile is fine: it's flagged again for the next tick
+    for (size_t i = 0; i < morphParameters.size(); ++i)
+    {
+        if (!morphValueChanged[i].exchange(false, std::memory_order_acquire))
+            continue;
+
+        auto& parameter = *morphParameters[i];
+
+        if (!morphGestureOpen[i])
+        {
+            parameter.beginChangeGesture();
+            morphGestureOpen[i] = true;
+        }
+
+        parameter.setValueNotifyingHost(morphValues[i].load(std::memory_order_relaxed));
+        anyChanged = true;
+    }
+
+    // The pad's spring keeps the values moving for a while after the mouse
+    // stops, so the drag is over once they've all been still a little while
+    if (anyChanged)
+        morphQuietTicks = 0;
+    else if (++morphQuietTicks >= morphGestureEndTicks)
+        endMorphGestures();
 }
 
-juce::AudioProcessorEditor* XYControlAudioProcessor::createEditor()
+void XYControlAudioProcessor::endMorphGestures()
 {
-    return new XYControlAudioProcessorEditor(*this);
+    for (size_t i = 0; i < morphParameters.size(); ++i)
+    {
+        if (morphGestureOpen[i])
+        {
+            morphParameters[i]->endChangeGesture();
+            morphGestureOpen[i] = false;
+        }
+    }
+}
+
+XYControlAudioProcessor::MorphCorners XYControlAudioProcessor::getMorphCorners() const
+{
+    const juce::ScopedLock lock(morphCornersLock);
+    return morphCorners;
+}
+
+void XYControlAudioProcessor::setMorphCorners(const MorphCorners& newCorners)
+{
+    // The lock only keeps writers apart; the audio thread never takes it
+    const juce::ScopedLock lock(morphCornersLock);
+
+    morphCorners = newCorners;
+    pendingMorphCorners.getWriteBuffer() = newCorners;
+    pendingMorphCorners.publish();
+}
+
+const char* XYControlAudioProcessor::getMorphCornerName(int corner)
+{
+    static const char* const names[] = { "bottom_left", "bottom_right", "top_left", "top_right" };
+    return names[corner];
 }
 
 void XYControlAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::ignoreUnused(destData);
+    if (auto xml = parameters.copyState().createXml())
+    {
+        // The corners go alongside the parameters, each as a list of values
+        auto corners = getMorphCorners();
+        auto* morphXml = xml->createNewChildElement(morphTag);
+
+        for (int corner = 0; corner < XYMorph::numCorners; ++corner)
+        {
+            juce::StringArray values;
+
+            for (auto value : corners[(size_t)corner])
+                values.add(juce::String(value));
+
+            morphXml->setAttribute(getMorphCornerName(corner), values.joinIntoString(" "));
+        }
+
+        copyXmlToBinary(*xml, destData);
+    }
 }
 
 void XYControlAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    juce::ignoreUnused(data, sizeInBytes);
+    // The editor, if open, picks the new position up on its next tick
+    if (auto xml = getXmlFromBinary(data, sizeInBytes))
+    {
+        if (!xml->hasTagName(parameters.state.getType()))
+            return;
+
+        // State from before there were corners keeps the ones there are
+        if (auto* morphXml = xml->getChildByName(morphTag))
+        {
+            auto corners = getMorphCorners();
+
+            for (int corner = 0; corner < XYMorph::numCorners; ++corner)
+            {
+                auto values = juce::StringArray::fromTokens(morphXml->getStringAttribute(getMorphCornerName(corner)), false);
+
+                for (int i = 0; i < juce::jmin(values.size(), numMorphParameters); ++i)
+                    corners[(size_t)corner][(size_t)i] = juce::jlimit(0.0f, 1.0f, values[i].getFloatValue());
+            }
+
+            setMorphCorners(corners);
+            xml->removeChildElement(morphXml, true);
+        }
+
+        parameters.replaceState(juce::ValueTree::fromXml(*xml));
+    }
 }
 
 // This creates new instances of the plugin
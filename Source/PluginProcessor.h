@@ -1,8 +1,13 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
+#include "XYModulator.h"
+#include "XYEffect.h"
+#include "XYMorph.h"
+#include "TripleBuffer.h"
 
-class XYControlAudioProcessor : public juce::AudioProcessor
+class XYControlAudioProcessor : public juce::AudioProcessor,
+                                private juce::Timer
 {
 public:
     XYControlAudioProcessor();
@@ -31,6 +36,92 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
+    // The pad's position as host-automatable parameters, 0..1 left to right
+    // and bottom to top. The editor writes them through the parameters as
+    // the user drags; the audio thread only ever loads their atomics.
+    juce::AudioProcessorValueTreeState parameters;
+
+    static inline const juce::ParameterID xParameterID { "x", 1 };
+    static inline const juce::ParameterID yParameterID { "y", 1 };
+
+    // Where the audio-rate spring was on the last sample processBlock()
+    // wrote. Only safe from the thread calling processBlock(), as tests do.
+    juce::Point<float> getModulatedPosition() const { return modulator.getPosition(); }
+
+    // Outputs rather than controls: the pad morphs them between four
+    // snapshots, one at each corner (XYMorph), and nothing in the plugin reads
+    // them back. They're for the host, to show or to map onto other plugins'
+    // parameters, so the pad works as a controller for the rest of the
+    // session. The audio thread works them out and the message thread passes
+    // on the ones that changed, so they aren't automatable: the pad drives
+    // them.
+    static constexpr int numMorphParameters = 8;
+
+    static juce::ParameterID getMorphParameterID(int index) { return { "morph" + juce::String(index + 1), 1 }; }
+
+    using MorphSnapshot = std::array<float, numMorphParameters>;
+    using MorphCorners = std::array<MorphSnapshot, XYMorph::numCorners>;
+
+    // Any thread but the audio thread. Taken up at the next block.
+    MorphCorners getMorphCorners() const;
+    void setMorphCorners(const MorphCorners& newCorners);
+
+    // For saving them: bottom_left, bottom_right, top_left, top_right
+    static const char* getMorphCornerName(int corner);
+
 private:
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    // Audio thread: takes up any new corners, morphs to x, y and leaves the
+    // values that changed for timerCallback()
+    void updateMorph(float x, float y);
+
+    // Message thread: tells the host about them. A drag reaches the host as
+    // one gesture per parameter, begun at its first change and ended once
+    // none has changed for morphGestureEndTicks.
+    void timerCallback() override;
+    void endMorphGestures();
+
+    static constexpr int morphNotifyRateHz = 60;
+    static constexpr int morphGestureEndTicks = morphNotifyRateHz / 4;    // A quarter of a second
+
+    static constexpr const char* morphTag = "MORPH";
+
+    std::atomic<float>* xParameter = nullptr;
+    std::atomic<float>* yParameter = nullptr;
+
+    // The parameters through the cursor's spring, per sample, for whatever
+    // the block drives. Sized in prepareToPlay(); longer blocks go through
+    // in pieces this long.
+    XYModulator modulator;
+    std::vector<float> modulationX, modulationY;
+
+    // The parameters only change between blocks, so a change is ramped over
+    // the block to land on its last sample rather than jumping at its first.
+    // Where the last block's ramp ended:
+    float blockTargetX = 0.5f;
+    float blockTargetY = 0.5f;
+    std::vector<float> targetRampX, targetRampY;
+
+    XYEffect effect;
+
+    std::array<juce::RangedAudioParameter*, numMorphParameters> morphParameters {};
+    XYMorph morph;
+
+    // From the audio thread to the message thread: each value, and whether
+    // it's changed since the host was last told
+    std::array<std::atomic<float>, numMorphParameters> morphValues {};
+    std::array<std::atomic<bool>, numMorphParameters> morphValueChanged {};
+
+    // Message thread only: which gestures are open, and how many ticks since
+    // any value changed
+    std::array<bool, numMorphParameters> morphGestureOpen {};
+    int morphQuietTicks = 0;
+
+    // The writers' copy, and the audio thread's way in to it
+    juce::CriticalSection morphCornersLock;
+    MorphCorners morphCorners;
+    TripleBuffer<MorphCorners> pendingMorphCorners;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(XYControlAudioProcessor)
 };
@@ -0,0 +1,220 @@
+#include "ProceduralGlow.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define PROCEDURALGLOW_SSE 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define PROCEDURALGLOW_NEON 1
+#endif
+
+namespace
+{
+    // Gradient alpha at t = distance / radius
+    float gradientAlpha(float t)
+    {
+        static const float positions[] = { 0.0f, 0.3f, 0.5f, 0.7f, 0.9f, 1.0f };
+        static const float alphas[]    = { 1.0f, 0.9f, 0.6f, 0.3f, 0.1f, 0.0f };
+
+        if (t >= 1.0f)
+            return 0.0f;
+
+        for (int i = 1; i < 6; ++i)
+        {
+            if (t <= positions[i])
+                return alphas[i - 1] + (alphas[i] - alphas[i - 1]) * (t - positions[i - 1]) / (positions[i] - positions[i - 1]);
+        }
+
+        return 0.0f;
+    }
+
+    // exp(-x) * I0(x), polynomial fits from Abramowitz & Stegun 9.8.1/9.8.2
+    double besselI0Scaled(double x)
+    {
+        if (x < 3.75)
+        {
+            double t = (x / 3.75) * (x / 3.75);
+            return (1.0 + t * (3.5156229 + t * (3.0899424 + t * (1.2067492
+                        + t * (0.2659732 + t * (0.0360768 + t * 0.0045813)))))) * std::exp(-x);
+        }
+
+        double t = 3.75 / x;
+        return (0.39894228 + t * (0.01328592 + t * (0.00225319 + t * (-0.00157565 + t * (0.00916281
+                + t * (-0.02057706 + t * (0.02635537 + t * (-0.01647633 + t * 0.00392377))))))))
+               / std::sqrt(x);
+    }
+
+    float sampleProfile(const float* profile, float position)
+    {
+        int index = (int)position;
+        float frac = position - (float)index;
+        return profile[index] + (profile[index + 1] - profile[index]) * frac;
+    }
+
+    juce::uint8 toByte(float value)
+    {
+        return (juce::uint8)juce::jlimit(0, 255, (int)(value + 0.5f));
+    }
+}
+
+ProceduralGlow::LayerSpec ProceduralGlow::getLayerSpec(int layerIndex, int size)
+{
+    // Must match the layer table in GenerateAllPresetImages
+    static const float alphas[numLayers] = { 0.95f, 0.75f, 0.60f, 0.45f, 0.35f };
+    static const int blurRadii[numLayers] = { 15, 20, 30, 40, 50 };
+
+    jassert(layerIndex >= 0 && layerIndex < numLayers);
+    return { size, alphas[layerIndex], blurRadii[layerIndex] };
+}
+
+std::vector<float> ProceduralGlow::computeProfile(const LayerSpec& spec, float scale, float maxRadius)
+{
+    const double radius = spec.size * 0.5 * scale;
+    const double sigma = juce::jmax(0.01, spec.blurRadius * 0.4 * scale);
+    const double step = 0.5;                    // Integration step along the source radius
+    const double reach = 4.0 * sigma;           // Gaussian is negligible beyond this
+
+    // Two extra samples so interpolation never reads past the end
+    const int numSamples = (int)std::ceil(maxRadius * samplesPerPixel) + 2;
+    std::vector<float> profile((size_t)numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Blurring a radial f(rho) with an isotropic Gaussian gives
+        //   B(r) = integral of f(rho) rho / s^2 exp(-(r^2 + rho^2) / 2s^2) I0(r rho / s^2) drho
+        // written here with the scaled I0 so nothing overflows
+        const double r = (double)i / samplesPerPixel;
+        const double first = juce::jmax(0.0, r - reach);
+        const double last = juce::jmin(radius, r + reach);
+        double sum = 0.0;
+
+        for (double rho = std::floor(first / step) * step; rho <= last; rho += step)
+        {
+            double f = gradientAlpha((float)(rho / radius));
+
+            if (f <= 0.0)
+                continue;
+
+            double d = r - rho;
+            sum += f * rho / (sigma * sigma) * std::exp(-d * d / (2.0 * sigma * sigma))
+                     * besselI0Scaled(r * rho / (sigma * sigma));
+        }
+
+        profile[(size_t)i] = (float)(sum * step * spec.alpha * 255.0);
+    }
+
+    return profile;
+}
+
+void ProceduralGlow::rasterise(const std::vector<float>& profile, juce::uint8* dest,
+                               int width, int height, int lineStride)
+{
+    const float centreX = width * 0.5f;
+    const float centreY = height * 0.5f;
+    const float* p = profile.data();
+
+    // Rows mirror around the centre, so only the top half is computed
+    for (int y = 0; y < (height + 1) / 2; ++y)
+    {
+        juce::uint8* line = dest + (size_t)y * (size_t)lineStride;
+        const float dy = (float)y + 0.5f - centreY;
+        const float dy2 = dy * dy;
+        int x = 0;
+
+       #if PROCEDURALGLOW_SSE
+        const __m128 dy2v = _mm_set1_ps(dy2);
+        const __m128 scale = _mm_set1_ps((float)samplesPerPixel);
+        __m128 dx = _mm_setr_ps(0.5f - centreX, 1.5f - centreX, 2.5f - centreX, 3.5f - centreX);
+        const __m128 four = _mm_set1_ps(4.0f);
+
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128 position = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2v)), scale);
+            __m128i index = _mm_cvttps_epi32(position);
+            __m128 frac = _mm_sub_ps(position, _mm_cvtepi32_ps(index));
+
+            alignas(16) int indices[4];
+            _mm_store_si128((__m128i*)indices, index);
+
+            __m128 a = _mm_setr_ps(p[indices[0]], p[indices[1]], p[indices[2]], p[indices[3]]);
+            __m128 b = _mm_setr_ps(p[indices[0] + 1], p[indices[1] + 1], p[indices[2] + 1], p[indices[3] + 1]);
+            __m128 value = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), frac));
+
+            // Round, then saturate down to bytes
+            __m128i ints = _mm_cvtps_epi32(value);
+            __m128i words = _mm_packs_epi32(ints, ints);
+            __m128i bytes = _mm_packus_epi16(words, words);
+            int packed = _mm_cvtsi128_si32(bytes);
+            std::memcpy(line + x, &packed, 4);
+
+            dx = _mm_add_ps(dx, four);
+        }
+       #elif PROCEDURALGLOW_NEON
+        const float32x4_t dy2v = vdupq_n_f32(dy2);
+        const float startOffsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+        float32x4_t dx = vsubq_f32(vld1q_f32(startOffsets), vdupq_n_f32(centreX));
+
+        for (; x + 4 <= width; x += 4)
+        {
+            float32x4_t position = vmulq_n_f32(vsqrtq_f32(vmlaq_f32(dy2v, dx, dx)), (float)samplesPerPixel);
+            int32x4_t index = vcvtq_s32_f32(position);
+            float32x4_t frac = vsubq_f32(position, vcvtq_f32_s32(index));
+
+            int indices[4];
+            vst1q_s32(indices, index);
+
+            const float aValues[4] = { p[indices[0]], p[indices[1]], p[indices[2]], p[indices[3]] };
+            const float bValues[4] = { p[indices[0] + 1], p[indices[1] + 1], p[indices[2] + 1], p[indices[3] + 1] };
+            float32x4_t a = vld1q_f32(aValues);
+            float32x4_t value = vmlaq_f32(a, vsubq_f32(vld1q_f32(bValues), a), frac);
+
+            uint32x4_t ints = vcvtq_u32_f32(vaddq_f32(vmaxq_f32(value, vdupq_n_f32(0.0f)), vdupq_n_f32(0.5f)));
+            uint16x4_t words = vqmovn_u32(ints);
+            uint8x8_t bytes = vqmovn_u16(vcombine_u16(words, words));
+            vst1_lane_u32((uint32_t*)(line + x), vreinterpret_u32_u8(bytes), 0);
+
+            dx = vaddq_f32(dx, vdupq_n_f32(4.0f));
+        }
+       #endif
+
+        for (; x < width; ++x)
+        {
+            float dx = (float)x + 0.5f - centreX;
+            line[x] = toByte(sampleProfile(p, std::sqrt(dx * dx + dy2) * samplesPerPixel));
+        }
+
+        int mirroredY = height - 1 - y;
+        if (mirroredY != y)
+            std::memcpy(dest + (size_t)mirroredY * (size_t)lineStride, line, (size_t)width);
+    }
+}
+
+juce::Image ProceduralGlow::renderMask(const LayerSpec& spec, float scale)
+{
+    const int imageSize = juce::jmax(1, juce::roundToInt((spec.size + spec.blurRadius * 2) * scale));
+
+    // Far enough for the corners of the image
+    const float maxRadius = imageSize * 0.5f * 1.4143f + 1.0f;
+    auto profile = computeProfile(spec, scale, maxRadius);
+
+    juce::Image mask(juce::Image::SingleChannel, imageSize, imageSize, false);
+    juce::Image::BitmapData data(mask, juce::Image::BitmapData::writeOnly);
+
+    if (data.pixelStride == 1)
+    {
+        rasterise(profile, data.data, imageSize, imageSize, data.lineStride);
+    }
+    else
+    {
+        juce::HeapBlock<juce::uint8> temp((size_t)imageSize * (size_t)imageSize);
+        rasterise(profile, temp, imageSize, imageSize, imageSize);
+
+        for (int y = 0; y < imageSize; ++y)
+            for (int x = 0; x < imageSize; ++x)
+                *data.getPixelPointer(x, y) = temp[(size_t)y * (size_t)imageSize + (size_t)x];
+    }
+
+    return mask;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+#include <vector>
+
+// Renders glow masks at runtime instead of loading pre-rendered ones.
+//
+// A glow layer is a radial gradient (stops at 0.3/0.5/0.7/0.9, same as
+// createBlurredGradient() in the generators) blurred with a Gaussian of
+// sigma = 0.4 * blurRadius. Both are radially symmetric, so the result is
+// too: it's computed once as a 1D falloff profile (the 2D blur of a radial
+// function reduces to a 1D integral with a Bessel I0 weight) and then swept
+// around the centre, a few milliseconds per layer at any size or scale.
+class ProceduralGlow
+{
+public:
+    struct LayerSpec
+    {
+        int size;           // Diameter of the gradient before blurring
+        float alpha;        // Peak opacity baked into the mask
+        int blurRadius;     // Padding on each side; sigma is 0.4x this
+    };
+
+    // Profile samples per pixel of radius
+    static constexpr int samplesPerPixel = 4;
+
+    static constexpr int numLayers = 5;
+
+    // Opacity and blur of layer i (0 = innermost), as the generators use them
+    static LayerSpec getLayerSpec(int layerIndex, int size);
+
+    // SingleChannel image laid out like the generated masks: a square of
+    // size + 2 * blurRadius with the glow centred, everything times scale
+    static juce::Image renderMask(const LayerSpec& spec, float scale = 1.0f);
+
+    // Blurred falloff from the centre out to maxRadius pixels, in 0..255,
+    // one sample every 1 / samplesPerPixel pixels
+    static std::vector<float> computeProfile(const LayerSpec& spec, float scale, float maxRadius);
+
+    // Sweeps the profile around the centre of a width x height 8-bit buffer
+    static void rasterise(const std::vector<float>& profile, juce::uint8* dest,
+                          int width, int height, int lineStride);
+};
@@ -0,0 +1,286 @@
+#include "SpringPhysics.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <immintrin.h>
+ #define SPRINGPHYSICS_SSE 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define SPRINGPHYSICS_NEON 1
+#endif
+
+namespace
+{
+    int roundUpToVector(int size)
+    {
+        return (size + SpringPhysics::vectorSize - 1) / SpringPhysics::vectorSize * SpringPhysics::vectorSize;
+    }
+
+    // Below these the trail's velocity is eased out, then dropped, so it
+    // settles without a visible snap
+    constexpr float decayBelow = 0.0005f;
+    constexpr float decayPerFrame = 0.98f;
+    constexpr float zeroBelow = 0.00001f;
+}
+
+//==============================================================================
+void SpringPhysics::Springs::resize(int newSize)
+{
+    for (auto* array : { &x, &y, &vx, &vy, &previousX, &previousY, &previousVx, &previousVy,
+                         &damping, &targetX, &targetY, &motion })
+        array->resize((size_t)newSize, 0.0f);
+
+    // Padding springs never move: no force, and a mass to divide by
+    stiffness.resize((size_t)newSize, 0.0f);
+    mass.resize((size_t)newSize, 1.0f);
+}
+
+void SpringPhysics::Springs::set(int index, const Parameters& parameters, juce::Point<float> position)
+{
+    auto i = (size_t)index;
+
+    x[i] = previousX[i] = targetX[i] = position.x;
+    y[i] = previousY[i] = targetY[i] = position.y;
+    vx[i] = vy[i] = previousVx[i] = previousVy[i] = motion[i] = 0.0f;
+    stiffness[i] = parameters.stiffness;
+    damping[i] = parameters.damping;
+    mass[i] = parameters.mass;
+}
+
+//==============================================================================
+int SpringPhysics::addCursor(const Parameters& lead, const std::vector<Parameters>& trail, juce::Point<float> start)
+{
+    int index = (int)cursors.size();
+
+    Cursor cursor;
+    cursor.trailStart = trails.size();
+    cursor.trailCount = (int)trail.size();
+    cursors.push_back(cursor);
+
+    leads.resize(roundUpToVector(index + 1));
+    leads.set(index, lead, start);
+
+    trails.resize(roundUpToVector(cursor.trailStart + cursor.trailCount));
+
+    int layer = cursor.trailStart;
+    for (auto& parameters : trail)
+        trails.set(layer++, parameters, start);
+
+    return index;
+}
+
+void SpringPhysics::setTarget(int cursor, float x, float y)
+{
+    leads.targetX[(size_t)cursor] = x;
+    leads.targetY[(size_t)cursor] = y;
+}
+
+SpringPhysics::State SpringPhysics::getState(int cursor, int layer, float alpha) const
+{
+    auto& s = layer == 0 ? leads : trails;
+    auto i = (size_t)(layer == 0 ? cursor : cursors[(size_t)cursor].trailStart + layer - 1);
+
+    if (alpha >= 1.0f)
+        return { s.x[i], s.y[i], s.vx[i], s.vy[i] };
+
+    auto blend = [alpha](float from, float to) { return from + (to - from) * alpha; };
+
+    return { blend(s.previousX[i], s.x[i]), blend(s.previousY[i], s.y[i]),
+             blend(s.previousVx[i], s.vx[i]), blend(s.previousVy[i], s.vy[i]) };
+}
+
+void SpringPhysics::addVelocity(int cursor, int layer, float dvx, float dvy)
+{
+    auto& springs = layer == 0 ? leads : trails;
+    auto i = (size_t)(layer == 0 ? cursor : cursors[(size_t)cursor].trailStart + layer - 1);
+
+    springs.vx[i] += dvx;
+    springs.vy[i] += dvy;
+}
+
+void SpringPhysics::step(float dt)
+{
+    // The decay was tuned per 60 Hz frame; shorter steps get less of it
+    const float decay = std::pow(decayPerFrame, dt);
+
+    integrate(leads, 0, leads.size(), dt, false, decay);
+
+    for (auto& cursor : cursors)
+    {
+        int begin = cursor.trailStart;
+        int end = begin + cursor.trailCount;
+        size_t lead = (size_t)(&cursor - cursors.data());
+
+        for (int i = begin; i < end; ++i)
+        {
+            trails.targetX[(size_t)i] = leads.x[lead];
+            trails.targetY[(size_t)i] = leads.y[lead];
+        }
+
+        cursor.trailMotion = integrate(trails, begin, roundUpToVector(end), dt, true, decay);
+    }
+}
+
+//==============================================================================
+// The vector paths do the same operations in the same order as the scalar
+// one, with separate multiplies and adds rather than fused ones (which
+// round once instead of twice), so all three give identical positions
+float SpringPhysics::integrate(Springs& s, int begin, int end, float dt, bool decayTrail, float decayFactor)
+{
+    jassert(begin % vectorSize == 0 && end % vectorSize == 0);
+
+    float total = 0.0f;
+    int i = begin;
+
+   #if SPRINGPHYSICS_SSE
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 decayLimit = _mm_set1_ps(decayBelow), decay = _mm_set1_ps(decayFactor);
+    const __m128 zeroLimit = _mm_set1_ps(zeroBelow);
+    __m128 motion = _mm_setzero_ps();
+
+    auto settle = [&](__m128 v)
+    {
+        __m128 slow = _mm_cmplt_ps(_mm_and_ps(v, absMask), decayLimit);
+        v = _mm_or_ps(_mm_and_ps(slow, _mm_mul_ps(v, decay)), _mm_andnot_ps(slow, v));
+        return _mm_andnot_ps(_mm_cmplt_ps(_mm_and_ps(v, absMask), zeroLimit), v);
+    };
+
+    for (; i < end; i += vectorSize)
+    {
+        __m128 x = _mm_load_ps(s.x.data() + i), y = _mm_load_ps(s.y.data() + i);
+        __m128 vx = _mm_load_ps(s.vx.data() + i), vy = _mm_load_ps(s.vy.data() + i);
+        __m128 stiffness = _mm_load_ps(s.stiffness.data() + i);
+        __m128 damping = _mm_load_ps(s.damping.data() + i);
+        __m128 mass = _mm_load_ps(s.mass.data() + i);
+
+        _mm_store_ps(s.previousX.data() + i, x);
+        _mm_store_ps(s.previousY.data() + i, y);
+        _mm_store_ps(s.previousVx.data() + i, vx);
+        _mm_store_ps(s.previousVy.data() + i, vy);
+
+        // Spring force less damping, over mass
+        __m128 ax = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(s.targetX.data() + i), x), stiffness),
+                                          _mm_mul_ps(vx, damping)), mass);
+        __m128 ay = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(s.targetY.data() + i), y), stiffness),
+                                          _mm_mul_ps(vy, damping)), mass);
+
+        vx = _mm_add_ps(vx, _mm_mul_ps(ax, step));
+        vy = _mm_add_ps(vy, _mm_mul_ps(ay, step));
+        x = _mm_add_ps(x, _mm_mul_ps(vx, step));
+        y = _mm_add_ps(y, _mm_mul_ps(vy, step));
+
+        if (decayTrail)
+        {
+            vx = settle(vx);
+            vy = settle(vy);
+        }
+
+        __m128 springMotion = _mm_add_ps(_mm_and_ps(vx, absMask), _mm_and_ps(vy, absMask));
+        motion = _mm_add_ps(motion, springMotion);
+
+        _mm_store_ps(s.x.data() + i, x);
+        _mm_store_ps(s.y.data() + i, y);
+        _mm_store_ps(s.vx.data() + i, vx);
+        _mm_store_ps(s.vy.data() + i, vy);
+        _mm_store_ps(s.motion.data() + i, springMotion);
+    }
+
+    alignas(16) float lanes[vectorSize];
+    _mm_store_ps(lanes, motion);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+   #elif SPRINGPHYSICS_NEON
+    const float32x4_t step = vdupq_n_f32(dt);
+    const float32x4_t decayLimit = vdupq_n_f32(decayBelow), decay = vdupq_n_f32(decayFactor);
+    const float32x4_t zeroLimit = vdupq_n_f32(zeroBelow), zero = vdupq_n_f32(0.0f);
+    float32x4_t motion = zero;
+
+    auto settle = [&](float32x4_t v)
+    {
+        v = vbslq_f32(vcltq_f32(vabsq_f32(v), decayLimit), vmulq_f32(v, decay), v);
+        return vbslq_f32(vcltq_f32(vabsq_f32(v), zeroLimit), zero, v);
+    };
+
+    for (; i < end; i += vectorSize)
+    {
+        float32x4_t x = vld1q_f32(s.x.data() + i), y = vld1q_f32(s.y.data() + i);
+        float32x4_t vx = vld1q_f32(s.vx.data() + i), vy = vld1q_f32(s.vy.data() + i);
+        float32x4_t stiffness = vld1q_f32(s.stiffness.data() + i);
+        float32x4_t damping = vld1q_f32(s.damping.data() + i);
+        float32x4_t mass = vld1q_f32(s.mass.data() + i);
+
+        vst1q_f32(s.previousX.data() + i, x);
+        vst1q_f32(s.previousY.data() + i, y);
+        vst1q_f32(s.previousVx.data() + i, vx);
+        vst1q_f32(s.previousVy.data() + i, vy);
+
+        // No vfma, as above
+        float32x4_t ax = vdivq_f32(vsubq_f32(vmulq_f32(vsubq_f32(vld1q_f32(s.targetX.data() + i), x), stiffness),
+                                             vmulq_f32(vx, damping)), mass);
+        float32x4_t ay = vdivq_f32(vsubq_f32(vmulq_f32(vsubq_f32(vld1q_f32(s.targetY.data() + i), y), stiffness),
+                                             vmulq_f32(vy, damping)), mass);
+
+        vx = vaddq_f32(vx, vmulq_f32(ax, step));
+        vy = vaddq_f32(vy, vmulq_f32(ay, step));
+        x = vaddq_f32(x, vmulq_f32(vx, step));
+        y = vaddq_f32(y, vmulq_f32(vy, step));
+
+        if (decayTrail)
+        {
+            vx = settle(vx);
+            vy = settle(vy);
+        }
+
+        float32x4_t springMotion = vaddq_f32(vabsq_f32(vx), vabsq_f32(vy));
+        motion = vaddq_f32(motion, springMotion);
+
+        vst1q_f32(s.x.data() + i, x);
+        vst1q_f32(s.y.data() + i, y);
+        vst1q_f32(s.vx.data() + i, vx);
+        vst1q_f32(s.vy.data() + i, vy);
+        vst1q_f32(s.motion.data() + i, springMotion);
+    }
+
+    float lanes[vectorSize];
+    vst1q_f32(lanes, motion);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+   #else
+    auto settle = [decayFactor](float v)
+    {
+        if (std::abs(v) < decayBelow)
+            v *= decayFactor;
+
+        return std::abs(v) < zeroBelow ? 0.0f : v;
+    };
+
+    for (; i < end; ++i)
+    {
+        auto n = (size_t)i;
+
+        s.previousX[n] = s.x[n];
+        s.previousY[n] = s.y[n];
+        s.previousVx[n] = s.vx[n];
+        s.previousVy[n] = s.vy[n];
+
+        // Spring force less damping, over mass
+        float ax = ((s.targetX[n] - s.x[n]) * s.stiffness[n] - s.vx[n] * s.damping[n]) / s.mass[n];
+        float ay = ((s.targetY[n] - s.y[n]) * s.stiffness[n] - s.vy[n] * s.damping[n]) / s.mass[n];
+
+        s.vx[n] += ax * dt;
+        s.vy[n] += ay * dt;
+        s.x[n] += s.vx[n] * dt;
+        s.y[n] += s.vy[n] * dt;
+
+        if (decayTrail)
+        {
+            s.vx[n] = settle(s.vx[n]);
+            s.vy[n] = settle(s.vy[n]);
+        }
+
+        s.motion[n] = std::abs(s.vx[n]) + std::abs(s.vy[n]);
+        total += s.motion[n];
+    }
+   #endif
+
+    return total;
+}
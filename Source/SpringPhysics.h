@@ -0,0 +1,106 @@
+#pragma once
+
+#include <juce_graphics/juce_graphics.h>
+#include <new>
+#include <vector>
+
+// Damped springs for the cursor and its glow trail, stored as parallel arrays
+// (x, y, vx, vy, stiffness, damping, mass, target) and stepped four at a time
+// with SSE or NEON. Each cursor has a lead spring chasing its target and any
+// number of trail springs chasing the lead; several cursors can share one
+// engine. The motion used to decide when things have settled is summed while
+// the springs are updated, rather than in another pass.
+class SpringPhysics
+{
+public:
+    struct Parameters
+    {
+        float stiffness;
+        float damping;
+        float mass;
+    };
+
+    struct State
+    {
+        float x, y;
+        float vx, vy;
+    };
+
+    // Returns the new cursor's index. Everything starts at rest at start.
+    int addCursor(const Parameters& lead, const std::vector<Parameters>& trail, juce::Point<float> start);
+
+    int getNumCursors() const { return (int)cursors.size(); }
+
+    // Lead plus trail
+    int getNumLayers(int cursor) const { return 1 + cursors[(size_t)cursor].trailCount; }
+
+    void setTarget(int cursor, float x, float y);
+
+    // Advances every spring by dt (in 60 Hz frames). Leads move first, then
+    // the trails chase where their lead has just got to.
+    void step(float dt);
+
+    // Layer 0 is the lead. alpha blends from the state before the last step
+    // (0) to the one after it (1), for drawing between fixed steps.
+    State getState(int cursor, int layer, float alpha = 1.0f) const;
+    void addVelocity(int cursor, int layer, float dvx, float dvy);
+
+    // |vx| + |vy| of the lead, and summed over the trail, as of the last step
+    float getLeadMotion(int cursor) const { return leads.motion[(size_t)cursor]; }
+    float getTrailMotion(int cursor) const { return cursors[(size_t)cursor].trailMotion; }
+
+    static constexpr int vectorSize = 4;
+
+private:
+    template <typename Type>
+    struct AlignedAllocator
+    {
+        using value_type = Type;
+        static constexpr std::size_t alignment = 32;
+
+        AlignedAllocator() = default;
+        template <typename Other> AlignedAllocator(const AlignedAllocator<Other>&) {}
+
+        Type* allocate(std::size_t n)
+        {
+            return static_cast<Type*>(::operator new(n * sizeof(Type), std::align_val_t(alignment)));
+        }
+
+        void deallocate(Type* ptr, std::size_t) { ::operator delete(ptr, std::align_val_t(alignment)); }
+
+        template <typename Other> bool operator==(const AlignedAllocator<Other>&) const { return true; }
+        template <typename Other> bool operator!=(const AlignedAllocator<Other>&) const { return false; }
+    };
+
+    using FloatArray = std::vector<float, AlignedAllocator<float>>;
+
+    // A set of springs, padded to whole vectors with springs that never move
+    struct Springs
+    {
+        FloatArray x, y, vx, vy;
+        FloatArray previousX, previousY, previousVx, previousVy;   // Before the last step
+        FloatArray stiffness, damping, mass;
+        FloatArray targetX, targetY;
+        FloatArray motion;
+
+        int size() const { return (int)x.size(); }
+        void resize(int newSize);
+        void set(int index, const Parameters& parameters, juce::Point<float> position);
+    };
+
+    struct Cursor
+    {
+        int trailStart = 0;         // Into trails
+        int trailCount = 0;
+        float trailMotion = 0.0f;
+    };
+
+    // Steps springs [begin, end) and returns their summed motion. Trails also
+    // get a gentle decay of tiny velocities, by decay per step, so they come
+    // fully to rest.
+    static float integrate(Springs& springs, int begin, int end, float dt, bool decayTrail, float decay);
+
+    Springs leads;                  // One per cursor
+    Springs trails;                 // Each cursor's run starts on a vector boundary
+    std::vector<Cursor> cursors;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Hands the latest value from one writer thread to one reader thread without
+// locks or waiting on either side. There are three copies: the writer fills
+// its own, then swaps it with the shared middle one; the reader swaps the
+// middle one for its own whenever something new was published. Neither ever
+// touches the copy the other is holding, and values in between can be
+// skipped, but the reader always gets a whole one.
+template <typename Type>
+class TripleBuffer
+{
+public:
+    // Writer thread: fill this, then publish()
+    Type& getWriteBuffer() { return buffers[(size_t)writeIndex]; }
+
+    void publish()
+    {
+        writeIndex = middle.exchange(writeIndex | freshFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader thread: takes the newest published value, if there is one since
+    // the last call, and returns whether it did. getReadBuffer() is the latest.
+    bool acquire()
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshFlag) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const Type& getReadBuffer() const { return buffers[(size_t)readIndex]; }
+
+private:
+    static constexpr int freshFlag = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<Type, 3> buffers {};
+    int writeIndex = 0;
+    std::atomic<int> middle { 1 };
+    int readIndex = 2;
+};
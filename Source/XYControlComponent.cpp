@@ -1,16 +1,7 @@
 #include "XYControlComponent.h"
-#include "BinaryData.h"
 
 XYControlComponent::XYControlComponent()
-    : springLayers{{
-        SpringLayer(0.20f, 1.13f, 1.6f),    // cursor - overdamped, zero bounce
-        SpringLayer(0.09f, 0.88f, 3.8f),    // inner
-        SpringLayer(0.07f, 0.85f, 5.2f),    // mid
-        SpringLayer(0.05f, 0.82f, 6.8f),    // outer
-        SpringLayer(0.04f, 0.78f, 8.5f),    // ambient
-        SpringLayer(0.03f, 0.75f, 10.5f)    // atmosphere
-    }},
-    glowLayers{{
+    : glowLayers{{
         {120, 0.95f, juce::Colours::black, {}},  // Will be set by preset
         {180, 0.75f, juce::Colours::black, {}},
         {260, 0.60f, juce::Colours::black, {}},
@@ -18,23 +9,64 @@ XYControlComponent::XYControlComponent()
         {480, 0.35f, juce::Colours::black, {}}
     }}
 {
-    lastFrameTime = juce::Time::currentTimeMillis();
-    startTimerHz(60);
+    simulation.readLatest(snapshot);
+    setFrameRate(activeFrameRateHz);
 
     updateColorsForPreset();
-    loadGlowImagesFromBinaryData();
+    loadGlowImages();
 }
 
 XYControlComponent::~XYControlComponent()
 {
+    animationClock->removeClient(*this, *this);
+    simulation.setThreadRunning(false);
 }
 
 void XYControlComponent::setPreset(Preset preset)
 {
     currentPreset = preset;
     updateColorsForPreset();
-    loadGlowImagesFromBinaryData();
+    loadGlowImages();
+
+    // Colours change everywhere, so this one needs the whole surface
+    lastAnimatedBounds = getAnimatedBounds();
     repaint();
+    wakeAnimation();
+}
+
+void XYControlComponent::setFrameRate(int rateHz)
+{
+    if (rateHz == schedulerStats.currentRateHz)
+        return;
+
+    animationClock->setFrameRate(*this, *this, rateHz);
+
+    schedulerStats.currentRateHz = rateHz;
+    ++schedulerStats.rateChanges;
+}
+
+void XYControlComponent::wakeAnimation()
+{
+    // Coming back from being stopped, don't let the gap count as a frame
+    if (schedulerStats.currentRateHz == 0 && !simulation.isRunningOnThread())
+        simulation.resetClock(juce::Time::getMillisecondCounterHiRes());
+
+    setFrameRate(activeFrameRateHz);
+}
+
+void XYControlComponent::scheduleNextFrame(bool isSettled)
+{
+    if (!isShowing())
+    {
+        setFrameRate(0);                        // Nothing on screen to animate
+        updateSimulationThread();
+    }
+    else if (snapshot.isBreathing)
+        setFrameRate(breathingFrameRateHz);     // Slow sine, half rate is plenty
+    else if (isSettled && snapshot.breatheBlend <= 0.0f)
+        setFrameRate(settledFrameRateHz);       // Only waiting for breathing to start
+    else
+        setFrameRate(activeFrameRateHz);
 }
 
 void XYControlComponent::constrainToRoundedBounds(float& x, float& y, float width, float height, float cornerRadius)
@@ -113,409 +145,613 @@ void XYControlComponent::updateColorsForPreset()
         case Preset::Blue:
             backgroundColor = juce::Colours::white;
             cursorColor = juce::Colours::white;
+            glowLayers[0].color = juce::Colour::fromFloatRGBA(0.0f, 0.55f, 1.0f, 1.0f);
+            glowLayers[1].color = juce::Colour::fromFloatRGBA(0.0f, 0.57f, 1.0f, 1.0f);
+            glowLayers[2].color = juce::Colour::fromFloatRGBA(0.04f, 0.59f, 1.0f, 1.0f);
+            glowLayers[3].color = juce::Colour::fromFloatRGBA(0.12f, 0.63f, 1.0f, 1.0f);
+            glowLayers[4].color = juce::Colour::fromFloatRGBA(0.20f, 0.69f, 1.0f, 1.0f);
             break;
 
         case Preset::Red:
             backgroundColor = juce::Colour(0xFFFF0000);  // Red
             cursorColor = juce::Colour(0xFFFF0000);      // Red
+            for (auto& layer : glowLayers)
+                layer.color = juce::Colours::black;      // Dark glow on red
             break;
 
         case Preset::Black:
             backgroundColor = juce::Colours::black;
             cursorColor = juce::Colours::black;
+            for (auto& layer : glowLayers)
+                layer.color = juce::Colours::white;      // White glow on black
             break;
     }
 }
 
-void XYControlComponent::loadGlowImagesFromBinaryData()
+void XYControlComponent::setGlowColour(juce::Colour colour)
 {
-    // Determine preset prefix and sizes
-    const char* presetName;
-    int sizes[5];
+    // Outer layers run slightly lighter, like the built-in blue
+    for (size_t i = 0; i < glowLayers.size(); ++i)
+        glowLayers[i].color = colour.withAlpha(1.0f).interpolatedWith(juce::Colours::white, (float)i * 0.05f);
+
+    repaint();
+}
+
+void XYControlComponent::loadGlowImages()
+{
+    // Determine mask set and sizes - the colour comes from the layer tints
+    const char* maskSetName;
+    GlowImageCache::LayerSizes sizes;
 
     switch (currentPreset)
     {
-        case Preset::Blue:
-            presetName = "blue";
-            sizes[0] = 120; sizes[1] = 180; sizes[2] = 260; sizes[3] = 360; sizes[4] = 480;
-            break;
-        case Preset::Red:
-            presetName = "red";
-            sizes[0] = 120; sizes[1] = 180; sizes[2] = 260; sizes[3] = 360; sizes[4] = 480;
-            break;
         case Preset::Black:
-            presetName = "black";
+            maskSetName = "compact";
             // Smaller sizes for white glow to compensate for visual contrast
-            sizes[0] = 100; sizes[1] = 150; sizes[2] = 215; sizes[3] = 300; sizes[4] = 400;
+            sizes = { 100, 150, 215, 300, 400 };
             break;
+        case Preset::Blue:
+        case Preset::Red:
         default:
-            presetName = "blue";
-            sizes[0] = 120; sizes[1] = 180; sizes[2] = 260; sizes[3] = 360; sizes[4] = 480;
+            maskSetName = "standard";
+            sizes = { 120, 180, 260, 360, 480 };
             break;
     }
 
+    // Rendered once per process and scale; these are shared references, not copies
+    auto& images = glowImageCache->getLayers(maskSetName, sizes, glowMaskScale);
+
     for (size_t i = 0; i < glowLayers.size(); ++i)
     {
         // Update layer size for current preset
         glowLayers[i].size = sizes[i];
+        glowLayers[i].cachedImage = images[i];
+        glowLayers[i].compositorMask = {};
+    }
 
-        // Construct resource name: "glow_blue_layer_0_png"
-        juce::String resourceName = juce::String("glow_") + presetName + "_layer_" + juce::String((int)i) + "_png";
+    if (renderSettings.cachedSurface && renderSettings.simdCompositor)
+    {
+        auto& masks = glowImageCache->getCompositorMasks(maskSetName, sizes, glowMaskScale);
 
-        // Get the binary data for this layer
-        int dataSize = 0;
-        const char* data = BinaryData::getNamedResource(resourceName.toRawUTF8(), dataSize);
+        for (size_t i = 0; i < glowLayers.size(); ++i)
+            glowLayers[i].compositorMask = masks[i];
 
-        if (data != nullptr && dataSize > 0)
+        if (renderSettings.spriteAtlas)
         {
-            // Load PNG from memory
-            glowLayers[i].cachedImage = juce::ImageFileFormat::loadFrom(data, (size_t)dataSize);
-        }
-        else
-        {
-            // Fallback: create a simple colored circle if resource missing
-            juce::Image fallback(juce::Image::ARGB, glowLayers[i].size, glowLayers[i].size, true);
-            juce::Graphics g(fallback);
-            g.setColour(glowLayers[i].color);
-            g.fillEllipse(0, 0, (float)glowLayers[i].size, (float)glowLayers[i].size);
-            glowLayers[i].cachedImage = fallback;
+            GlowSpriteAtlas::Settings atlasSettings;
+            atlasSettings.errorBudget = renderSettings.spriteAtlasErrorBudget;
+
+            // Blue and Red share masks, so switching between them keeps the stamps
+            if (spriteAtlas == nullptr || !spriteAtlas->matches(masks, atlasSettings))
+            {
+                GlowSpriteAtlas::CometShapes shapes;
+
+                for (size_t i = 0; i < shapes.size(); ++i)
+                    shapes[i] = getCometShape((int)i);
+
+                spriteAtlas = std::make_unique<GlowSpriteAtlas>(masks, shapes, atlasSettings);
+            }
+
+            return;
         }
     }
+
+    spriteAtlas.reset();
 }
 
-void XYControlComponent::paint(juce::Graphics& g)
+XYControlComponent::LayerMotion XYControlComponent::getLayerMotion(int i) const
 {
-    auto bounds = getLocalBounds();
+    auto spring = snapshot.getState(i + 1, renderAlpha);
+    LayerMotion motion;
 
-    // Draw rounded rectangle background with preset color
-    g.setColour(backgroundColor);
-    g.fillRoundedRectangle(bounds.toFloat(), 24.0f);
+    // Calculate velocity magnitude and direction (always, for smooth blending)
+    float speed = std::sqrt(spring.vx * spring.vx + spring.vy * spring.vy);
 
-    // Enable high quality rendering
-    g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+    if (speed > 0.0001f)
+    {
+        motion.isMoving = true;
 
-    // Clip to rounded rectangle
-    juce::Path clipPath;
-    clipPath.addRoundedRectangle(bounds.toFloat(), 24.0f);
-    g.reduceClipRegion(clipPath);
+        // Angle of movement
+        motion.angle = std::atan2(spring.vy, spring.vx);
 
-    // Draw glow layers from back to front
-    for (int i = 4; i >= 0; --i)
-    {
-        auto& spring = springLayers[i + 1];
-        auto& layer = glowLayers[i];
+        // Speed-based stretching factor with smooth falloff
+        motion.speedFactor = 1.0f - std::exp(-speed * 8.0f);
+    }
 
-        float pixelX = spring.x * bounds.getWidth();
-        float pixelY = spring.y * bounds.getHeight();
+    return motion;
+}
 
-        float scaleX = 1.0f;
-        float scaleY = 1.0f;
-        float offsetX = 0.0f;
-        float offsetY = 0.0f;
-        float rotation = 0.0f;
-        float opacity = layer.opacity;
+GlowSpriteAtlas::CometShape XYControlComponent::getCometShape(int i) const
+{
+    // More dramatic on outer layers
+    float stretchMultiplier = 1.0f + i * 0.3f;
 
-        // Calculate velocity magnitude and direction (always, for smooth blending)
-        float speed = std::sqrt(spring.vx * spring.vx + spring.vy * spring.vy);
+    return { 1.2f + stretchMultiplier,     // Stretch along direction of movement
+             0.5f + i * 0.1f,              // Squash perpendicular
+             glowLayers[(size_t)i].opacity };
+}
 
-        // Motion-based deformation
-        if (speed > 0.0001f)
-        {
-            // Angle of movement
-            rotation = std::atan2(spring.vy, spring.vx);
-
-            // Speed-based stretching factor with smooth falloff
-            float speedFactor = 1.0f - std::exp(-speed * 8.0f);
-
-            // Create comet tail effect:
-            // - Stretch along direction of movement (scaleX)
-            // - Squash perpendicular (scaleY)
-            // - More dramatic on outer layers
-            float stretchMultiplier = 1.0f + i * 0.3f;
-            scaleX = 1.0f + speedFactor * (1.2f + stretchMultiplier);  // Stretch behind
-            scaleY = 1.0f / (1.0f + speedFactor * (0.5f + i * 0.1f)); // Squash sides
-
-            // Offset layers backward along movement vector for tail effect
-            float offsetAmount = speedFactor * (15.0f + i * 8.0f);
-            offsetX = -std::cos(rotation) * offsetAmount;
-            offsetY = -std::sin(rotation) * offsetAmount;
-        }
+XYControlComponent::LayerTransform XYControlComponent::getLayerTransform(int i, juce::Rectangle<int> bounds) const
+{
+    auto spring = snapshot.getState(i + 1, renderAlpha);
+    auto& layer = glowLayers[(size_t)i];
 
-        // Blend in breathing animation when idle
-        if (isBreathing && breatheBlend > 0.0f)
-        {
-            // Breathing animation with slightly different timing for each layer
-            float breathePhase = breatheTime + i * 0.3f;
-            float breatheScale = 1.0f + 0.08f * std::sin(breathePhase);
-            float breatheOpacity = 0.85f + 0.15f * (0.5f + 0.5f * std::sin(breathePhase));
-
-            // Smoothly blend from motion state to breathing state
-            scaleX = scaleX * (1.0f - breatheBlend) + breatheScale * breatheBlend;
-            scaleY = scaleY * (1.0f - breatheBlend) + breatheScale * breatheBlend;
-            opacity = opacity * (1.0f - breatheBlend) + (layer.opacity * breatheOpacity) * breatheBlend;
-
-            // Fade out motion-based rotation and offset
-            rotation *= (1.0f - breatheBlend);
-            offsetX *= (1.0f - breatheBlend);
-            offsetY *= (1.0f - breatheBlend);
-        }
+    float pixelX = spring.x * bounds.getWidth();
+    float pixelY = spring.y * bounds.getHeight();
 
-        // Draw the cached blurred image with comet transformation
-        g.setOpacity(opacity);
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+    float rotation = 0.0f;
+    float opacity = layer.opacity;
 
-        // Create proper directional stretch transform
-        float centerX = layer.cachedImage.getWidth() / 2.0f;
-        float centerY = layer.cachedImage.getHeight() / 2.0f;
+    // Motion-based deformation
+    auto motion = getLayerMotion(i);
 
-        juce::AffineTransform transform = juce::AffineTransform()
-            .translated(-centerX, -centerY)                    // Center at origin
-            .scaled(scaleX, scaleY)                            // Apply scale
-            .followedBy(juce::AffineTransform::rotation(rotation)) // Rotate
-            .translated(pixelX + offsetX, pixelY + offsetY);   // Move to position
+    if (motion.isMoving)
+    {
+        rotation = motion.angle;
+        float speedFactor = motion.speedFactor;
+
+        // Create comet tail effect: stretch behind, squash the sides
+        auto comet = getCometShape(i);
+        scaleX = 1.0f + speedFactor * comet.stretch;
+        scaleY = 1.0f / (1.0f + speedFactor * comet.squash);
+
+        // Offset layers backward along movement vector for tail effect
+        float offsetAmount = speedFactor * (15.0f + i * 8.0f);
+        offsetX = -std::cos(rotation) * offsetAmount;
+        offsetY = -std::sin(rotation) * offsetAmount;
+    }
 
-        g.drawImageTransformed(layer.cachedImage, transform, false);
+    // Blend in breathing animation when idle
+    if (snapshot.isBreathing && snapshot.breatheBlend > 0.0f)
+    {
+        // Breathing animation with slightly different timing for each layer
+        float breatheBlend = snapshot.breatheBlend;
+        float breathePhase = snapshot.breatheTime + i * 0.3f;
+        float breatheScale = 1.0f + 0.08f * std::sin(breathePhase);
+        float breatheOpacity = 0.85f + 0.15f * (0.5f + 0.5f * std::sin(breathePhase));
+
+        // Smoothly blend from motion state to breathing state
+        scaleX = scaleX * (1.0f - breatheBlend) + breatheScale * breatheBlend;
+        scaleY = scaleY * (1.0f - breatheBlend) + breatheScale * breatheBlend;
+        opacity = opacity * (1.0f - breatheBlend) + (layer.opacity * breatheOpacity) * breatheBlend;
+
+        // Fade out motion-based rotation and offset
+        rotation *= (1.0f - breatheBlend);
+        offsetX *= (1.0f - breatheBlend);
+        offsetY *= (1.0f - breatheBlend);
     }
 
-    // Draw solid cursor with preset color
-    g.setOpacity(1.0f);
+    // Create proper directional stretch transform
+    float centerX = layer.cachedImage.getWidth() / (2.0f * glowMaskScale);
+    float centerY = layer.cachedImage.getHeight() / (2.0f * glowMaskScale);
 
-    float cursorX = springLayers[0].x * bounds.getWidth();
-    float cursorY = springLayers[0].y * bounds.getHeight();
-    float cursorRadius = isDragging ? 8.0f : 9.0f;
+    LayerTransform result;
+    result.opacity = opacity;
+    result.transform = juce::AffineTransform::scale(1.0f / glowMaskScale) // Mask pixels to logical
+        .translated(-centerX, -centerY)                    // Center at origin
+        .scaled(scaleX, scaleY)                            // Apply scale
+        .followedBy(juce::AffineTransform::rotation(rotation)) // Rotate
+        .translated(pixelX + offsetX, pixelY + offsetY);   // Move to position
 
-    // Solid cursor circle
-    g.setColour(cursorColor);
-    g.fillEllipse(cursorX - cursorRadius, cursorY - cursorRadius,
-                  cursorRadius * 2, cursorRadius * 2);
+    return result;
 }
 
-void XYControlComponent::resized()
+juce::Rectangle<float> XYControlComponent::getCursorBounds(juce::Rectangle<int> bounds) const
 {
+    auto lead = snapshot.getState(0, renderAlpha);
+    float cursorX = lead.x * bounds.getWidth();
+    float cursorY = lead.y * bounds.getHeight();
+    float cursorRadius = snapshot.isDragging ? 8.0f : 9.0f;
+
+    return { cursorX - cursorRadius, cursorY - cursorRadius, cursorRadius * 2, cursorRadius * 2 };
 }
 
-void XYControlComponent::mouseDown(const juce::MouseEvent& event)
+juce::Rectangle<int> XYControlComponent::getAnimatedBounds() const
 {
-    // Immediately stop breathing to prevent jitter
-    isBreathing = false;
-    breatheBlend = 0.0f;
-    idleTimer = 0.0f;
-    isDragging = true;
+    auto bounds = getLocalBounds();
+    auto area = getCursorBounds(bounds);
 
-    auto bounds = getLocalBounds().toFloat();
-    targetX = event.position.x / bounds.getWidth();
-    targetY = event.position.y / bounds.getHeight();
+    for (int i = 0; i < (int)glowLayers.size(); ++i)
+    {
+        auto imageBounds = glowLayers[(size_t)i].cachedImage.getBounds().toFloat();
+        area = area.getUnion(imageBounds.transformedBy(getLayerTransform(i, bounds).transform));
+    }
 
-    repaint();
+    // Pad by a pixel or two for anti-aliased edges and resampling
+    return area.expanded(2.0f).getSmallestIntegerContainer().getIntersection(bounds);
 }
 
-void XYControlComponent::mouseDrag(const juce::MouseEvent& event)
+void XYControlComponent::repaintAnimatedRegion()
 {
-    // Ensure breathing is stopped during any drag
-    isBreathing = false;
-    breatheBlend = 0.0f;
-    idleTimer = 0.0f;
+    // Repaint where the glow was last frame plus where it is now
+    auto currentBounds = getAnimatedBounds();
+    auto dirtyBounds = currentBounds.getUnion(lastAnimatedBounds);
+    lastAnimatedBounds = currentBounds;
 
-    auto bounds = getLocalBounds().toFloat();
-    float newX = event.position.x;
-    float newY = event.position.y;
-
-    // Constrain to rounded rectangle
-    constrainToRoundedBounds(newX, newY, bounds.getWidth(), bounds.getHeight(), 24.0f);
-
-    targetX = newX / bounds.getWidth();
-    targetY = newY / bounds.getHeight();
+    if (!dirtyBounds.isEmpty())
+        repaint(dirtyBounds);
+}
 
+void XYControlComponent::setRenderSettings(const RenderSettings& newSettings)
+{
+    renderSettings = newSettings;
+    surfaceFrame = {};
+    loadGlowImages();
     repaint();
 }
 
-void XYControlComponent::mouseUp(const juce::MouseEvent&)
+GlowSpriteAtlas::Stats XYControlComponent::getSpriteAtlasStats() const
 {
-    // Don't immediately set isDragging to false - let motion settle first
-    // This prevents sudden changes when releasing
-    isDragging = false;
-
-    // Don't reset idle timer - let it accumulate naturally
-    // idleTimer will start when velocity drops below threshold
-
-    repaint();
+    return spriteAtlas != nullptr ? spriteAtlas->getStats() : GlowSpriteAtlas::Stats();
 }
 
-void XYControlComponent::mouseDoubleClick(const juce::MouseEvent& event)
+void XYControlComponent::paint(juce::Graphics& g)
 {
-    // Trigger disperse effect
-    isDispersing = true;
-    disperseTime = 0.0f;
-    isBreathing = false;
-    breatheBlend = 0.0f;
+    auto bounds = getLocalBounds();
 
-    // Add radial outward velocity to all glow layers
-    // Use golden angle for better distribution
-    const float goldenAngle = 2.39996f; // Golden angle in radians
-    float baseAngle = juce::Random::getSystemRandom().nextFloat() * 6.28318f;
+    // Being painted means we're on screen again (e.g. the parent window was shown)
+    if (schedulerStats.currentRateHz == 0)
+        wakeAnimation();
 
-    for (size_t i = 1; i < springLayers.size(); ++i)
+    // Render the masks at the display's density so they stay sharp on HiDPI
+    // screens. Logical sizes don't change, so the dirty areas still line up.
+    float pixelScale = juce::jlimit(1.0f, 4.0f, g.getInternalContext().getPhysicalPixelScaleFactor());
+    if (pixelScale != glowMaskScale)
     {
-        // Use golden angle spiral for natural, even distribution
-        float angle = baseAngle + (i - 1) * goldenAngle;
-        float dx = std::cos(angle);
-        float dy = std::sin(angle);
-
-        // Apply outward impulse - stronger for outer layers
-        float impulse = 0.08f + i * 0.025f;
-        springLayers[i].vx += dx * impulse;
-        springLayers[i].vy += dy * impulse;
+        glowMaskScale = pixelScale;
+        loadGlowImages();
     }
 
-    repaint();
+    if (renderSettings.cachedSurface)
+        paintCachedSurface(g, bounds, pixelScale);
+    else
+        paintClippedSurface(g, bounds);
 }
 
-void XYControlComponent::timerCallback()
+void XYControlComponent::paintClippedSurface(juce::Graphics& g, juce::Rectangle<int> bounds)
 {
-    int64_t currentTime = juce::Time::currentTimeMillis();
-    float dt = juce::jmin((currentTime - lastFrameTime) / 16.67f, 2.0f);
-    lastFrameTime = currentTime;
+    // Draw rounded rectangle background with preset color
+    g.setColour(backgroundColor);
+    g.fillRoundedRectangle(bounds.toFloat(), cornerRadius);
+
+    // Clip to rounded rectangle
+    juce::Path clipPath;
+    clipPath.addRoundedRectangle(bounds.toFloat(), cornerRadius);
+    g.reduceClipRegion(clipPath);
+
+    paintGlowLayers(g, bounds);
+    paintCursor(g, bounds);
+}
+
+void XYControlComponent::paintCachedSurface(juce::Graphics& g, juce::Rectangle<int> bounds, float scale)
+{
+    if (scale != surfaceScale || !surfaceFrame.isValid())
+        updateSurface(scale);
+
+    // Only the part being repainted is rebuilt, in frame pixels
+    auto dirty = (g.getClipBounds().toFloat() * scale).getSmallestIntegerContainer()
+                     .getIntersection(surfaceFrame.getBounds());
 
-    // Update all spring layers
-    springLayers[0].update(targetX, targetY, dt);
+    if (dirty.isEmpty())
+        return;
 
-    for (size_t i = 1; i < springLayers.size(); ++i)
+    // Square corners, rectangle clip only: no path, no edge table
+    surfaceFrame.clear(dirty, backgroundColor);
+
+    bool composited = false;
+
+    if (renderSettings.simdCompositor && glowLayers[0].compositorMask.isValid())
     {
-        springLayers[i].update(springLayers[0].x, springLayers[0].y, dt);
-
-        // Very gradual velocity decay for smoothest settling
-        // Only decay when extremely small to prevent any snapping
-        if (std::abs(springLayers[i].vx) < 0.0005f)
-            springLayers[i].vx *= 0.98f;  // More gradual
-        if (std::abs(springLayers[i].vy) < 0.0005f)
-            springLayers[i].vy *= 0.98f;
-
-        // Only fully zero out when microscopic
-        if (std::abs(springLayers[i].vx) < 0.00001f)
-            springLayers[i].vx = 0.0f;
-        if (std::abs(springLayers[i].vy) < 0.00001f)
-            springLayers[i].vy = 0.0f;
+        compositeGlowLayers(dirty, bounds, scale);
+        composited = true;
     }
 
-    // Update disperse effect
-    if (isDispersing)
     {
-        disperseTime += dt * 16.67f;
-        if (disperseTime > 500.0f)  // Effect lasts ~500ms
-        {
-            isDispersing = false;
-        }
+        juce::Graphics frame(surfaceFrame);
+        frame.reduceClipRegion(dirty);
+        frame.addTransform(juce::AffineTransform::scale(scale));
+
+        if (!composited)
+            paintGlowLayers(frame, bounds);
+
+        paintCursor(frame, bounds);
     }
 
-    // Check for idle state - use blur layers to determine true stillness
-    float totalVelocity = std::abs(springLayers[0].vx) + std::abs(springLayers[0].vy);
-    float blurVelocity = 0.0f;
-    for (size_t i = 1; i < springLayers.size(); ++i)
+    applyCornerCoverage(dirty);
+
+    g.drawImageTransformed(surfaceFrame, juce::AffineTransform::scale(1.0f / scale));
+}
+
+void XYControlComponent::paintGlowLayers(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    // Enable high quality rendering
+    g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+
+    // Draw glow layers from back to front
+    for (int i = 4; i >= 0; --i)
     {
-        blurVelocity += std::abs(springLayers[i].vx) + std::abs(springLayers[i].vy);
+        auto& layer = glowLayers[(size_t)i];
+        auto layerTransform = getLayerTransform(i, bounds);
+
+        // Draw the cached blur mask tinted with the layer colour, with comet transformation
+        g.setColour(layer.color);
+        g.setOpacity(layerTransform.opacity);
+        g.drawImageTransformed(layer.cachedImage, layerTransform.transform, true);
     }
+}
 
-    if (totalVelocity < 0.001f && blurVelocity < 0.01f && !isDragging && !isDispersing)
+void XYControlComponent::compositeGlowLayers(juce::Rectangle<int> dirty, juce::Rectangle<int> bounds, float scale)
+{
+    // Same layers, order and tints as paintGlowLayers(), in frame pixels
+    std::array<GlowCompositor::Layer, 5> layers;
+
+    // Stamps are rendered at the masks' scale, and don't cover breathing
+    bool useAtlas = spriteAtlas != nullptr && scale == glowMaskScale && !(snapshot.isBreathing && snapshot.breatheBlend > 0.0f);
+
+    if (useAtlas)
+        spriteAtlas->beginFrame();
+
+    for (int i = 4; i >= 0; --i)
     {
-        idleTimer += dt * 16.67f;
-        if (idleTimer > 500.0f)  // Longer delay before breathing starts
+        auto& layer = glowLayers[(size_t)i];
+        auto layerTransform = getLayerTransform(i, bounds);
+        auto& target = layers[(size_t)(4 - i)];
+
+        target = { &layer.compositorMask,
+                   layerTransform.transform.scaled(scale),
+                   layer.color.withAlpha(layerTransform.opacity) };
+
+        if (useAtlas)
         {
-            if (!isBreathing)
+            auto motion = getLayerMotion(i);
+            auto match = spriteAtlas->find(i, motion.speedFactor, motion.angle);
+
+            if (match.stamp != nullptr)
             {
-                // Start breathing at neutral phase (where sin = 0) to avoid snap
-                breatheTime = 0.0f;
-                breatheBlend = 0.0f;  // Start blend at 0
-                isBreathing = true;
+                // The stamp goes wherever the transform puts the mask's centre
+                float centreX = 0.5f * (float)layer.compositorMask.width;
+                float centreY = 0.5f * (float)layer.compositorMask.height;
+                target.transform.transformPoint(centreX, centreY);
+
+                target.stamp = match.stamp;
+                target.stampCentre = { centreX, centreY };
+                target.stampFlipped = match.flipped;
             }
         }
     }
-    else
-    {
-        idleTimer = 0.0f;
-        isBreathing = false;  // Stop breathing when motion detected
-    }
 
-    // Update breathing animation time and blend
-    if (isBreathing)
-    {
-        breatheTime += 0.025f;
+    juce::Image::BitmapData frameData(surfaceFrame, juce::Image::BitmapData::readWrite);
+    GlowCompositor::composite(layers.data(), (int)layers.size(), frameData, dirty,
+                              renderSettings.tileParallel ? compositorWorkers.get() : nullptr);
+}
+
+void XYControlComponent::paintCursor(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    // Solid cursor circle with preset color
+    g.setOpacity(1.0f);
+    g.setColour(cursorColor);
+    g.fillEllipse(getCursorBounds(bounds));
+}
+
+void XYControlComponent::updateSurface(float scale)
+{
+    surfaceScale = scale;
+
+    int width = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    int height = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+
+    // Software images so BitmapData is direct access on every platform
+    surfaceFrame = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    surfaceCoverage = juce::Image(juce::Image::SingleChannel, width, height, true, juce::SoftwareImageType());
 
-        // Smoothly ramp up breathe blend over ~1 second
-        breatheBlend = juce::jmin(1.0f, breatheBlend + 0.015f);
-    }
-    else
     {
-        // Quickly fade out breathing when motion starts
-        breatheBlend = juce::jmax(0.0f, breatheBlend - 0.08f);
+        juce::Graphics g(surfaceCoverage);
+        g.setColour(juce::Colours::white);
+        g.fillRoundedRectangle(surfaceCoverage.getBounds().toFloat(), cornerRadius * scale);
     }
 
-    repaint();
+    // Everywhere else the coverage is 255, so only the corners need the mask
+    int size = juce::jmin(juce::roundToInt(std::ceil(cornerRadius * scale)) + 1, width / 2, height / 2);
+    surfaceCorners = {{ { 0, 0, size, size },
+                        { width - size, 0, size, size },
+                        { 0, height - size, size, size },
+                        { width - size, height - size, size, size } }};
 }
 
-void XYControlComponent::constrainToRoundedBounds(float& x, float& y, float width, float height, float cornerRadius)
+void XYControlComponent::applyCornerCoverage(juce::Rectangle<int> dirty)
 {
-    // First, basic clamp to rectangle
-    x = juce::jlimit(0.0f, width, x);
-    y = juce::jlimit(0.0f, height, y);
+    juce::Image::BitmapData frameData(surfaceFrame, juce::Image::BitmapData::readWrite);
+    juce::Image::BitmapData coverageData(surfaceCoverage, juce::Image::BitmapData::readOnly);
 
-    // Check if we're in a corner region
-    // Top-left corner
-    if (x < cornerRadius && y < cornerRadius)
+    for (auto& corner : surfaceCorners)
     {
-        float cx = cornerRadius;
-        float cy = cornerRadius;
-        float dx = x - cx;
-        float dy = y - cy;
-        float dist = std::sqrt(dx * dx + dy * dy);
+        auto area = corner.getIntersection(dirty);
 
-        if (dist > cornerRadius)
+        for (int y = area.getY(); y < area.getBottom(); ++y)
         {
-            x = cx + (dx / dist) * cornerRadius;
-            y = cy + (dy / dist) * cornerRadius;
+            auto* coverage = coverageData.getPixelPointer(area.getX(), y);
+            auto* pixel = reinterpret_cast<juce::PixelARGB*>(frameData.getPixelPointer(area.getX(), y));
+
+            for (int x = 0; x < area.getWidth(); ++x)
+            {
+                if (coverage[x] != 255)
+                    pixel[x].multiplyAlpha(coverage[x]);
+            }
         }
     }
-    // Top-right corner
-    else if (x > width - cornerRadius && y < cornerRadius)
+}
+
+void XYControlComponent::resized()
+{
+    lastAnimatedBounds = {};
+    surfaceFrame = {};
+    repaint();
+}
+
+void XYControlComponent::visibilityChanged()
+{
+    updateSimulationThread();
+
+    if (isShowing())
+        wakeAnimation();
+}
+
+void XYControlComponent::parentHierarchyChanged()
+{
+    updateSimulationThread();
+
+    if (isShowing())
+        wakeAnimation();
+}
+
+void XYControlComponent::updateSimulationThread()
+{
+    // Hidden, there's nothing to step it for; offline it's stepped by hand
+    simulation.setThreadRunning(isShowing());
+}
+
+void XYControlComponent::setTarget(juce::Point<float> target)
+{
+    auto bounds = getLocalBounds().toFloat();
+    XYSimulation::Input move { XYSimulation::Input::move, target.x, target.y };
+
+    if (!bounds.isEmpty())
     {
-        float cx = width - cornerRadius;
-        float cy = cornerRadius;
-        float dx = x - cx;
-        float dy = y - cy;
-        float dist = std::sqrt(dx * dx + dy * dy);
+        float newX = target.x * bounds.getWidth();
+        float newY = target.y * bounds.getHeight();
+        constrainToRoundedBounds(newX, newY, bounds.getWidth(), bounds.getHeight(), cornerRadius);
 
-        if (dist > cornerRadius)
-        {
-            x = cx + (dx / dist) * cornerRadius;
-            y = cy + (dy / dist) * cornerRadius;
-        }
+        move.x = newX / bounds.getWidth();
+        move.y = newY / bounds.getHeight();
     }
-    // Bottom-left corner
-    else if (x < cornerRadius && y > height - cornerRadius)
+
+    // Not an event from the user, so not stamped: it lands on the next step
+    simulation.post(move);
+    wakeAnimation();
+}
+
+void XYControlComponent::mouseDown(const juce::MouseEvent& event)
+{
+    auto bounds = getLocalBounds().toFloat();
+    float newX = event.position.x;
+    float newY = event.position.y;
+
+    // Same as a drag, so a click in a corner doesn't report a point off the pad
+    constrainToRoundedBounds(newX, newY, bounds.getWidth(), bounds.getHeight(), cornerRadius);
+
+    XYSimulation::Input press { XYSimulation::Input::press,
+                                newX / bounds.getWidth(),
+                                newY / bounds.getHeight() };
+    postInput(press, event);
+
+    if (onDragStart != nullptr)
+        onDragStart();
+
+    if (onTargetChanged != nullptr)
+        onTargetChanged({ press.x, press.y });
+}
+
+void XYControlComponent::mouseDrag(const juce::MouseEvent& event)
+{
+    auto bounds = getLocalBounds().toFloat();
+    float newX = event.position.x;
+    float newY = event.position.y;
+
+    // Constrain to rounded rectangle
+    constrainToRoundedBounds(newX, newY, bounds.getWidth(), bounds.getHeight(), cornerRadius);
+
+    juce::Point<float> target(newX / bounds.getWidth(), newY / bounds.getHeight());
+    postInput({ XYSimulation::Input::drag, target.x, target.y }, event);
+
+    if (onTargetChanged != nullptr)
+        onTargetChanged(target);
+}
+
+void XYControlComponent::mouseUp(const juce::MouseEvent& event)
+{
+    // The glow keeps moving until it settles; the simulation only starts
+    // counting towards breathing then
+    postInput({ XYSimulation::Input::release }, event);
+
+    if (onDragEnd != nullptr)
+        onDragEnd();
+}
+
+void XYControlComponent::mouseDoubleClick(const juce::MouseEvent& event)
+{
+    // Trigger disperse effect, pushing the glow layers out in a golden
+    // angle spiral from a random start
+    XYSimulation::Input disperse { XYSimulation::Input::disperse };
+    disperse.angle = juce::Random::getSystemRandom().nextFloat() * 6.28318f;
+    postInput(disperse, event);
+}
+
+void XYControlComponent::postInput(XYSimulation::Input input, const juce::MouseEvent& event)
+{
+    // On the thread, each sample goes to the step it happened in. Stepped by
+    // hand there's no real clock to place it on, so it's just the next step.
+    if (simulation.isRunningOnThread())
     {
-        float cx = cornerRadius;
-        float cy = height - cornerRadius;
-        float dx = x - cx;
-        float dy = y - cy;
-        float dist = std::sqrt(dx * dx + dy * dy);
+        auto now = juce::Time::getMillisecondCounterHiRes();
+        auto age = (double)(juce::Time::getCurrentTime() - event.eventTime).inMilliseconds();
 
-        if (dist > cornerRadius)
-        {
-            x = cx + (dx / dist) * cornerRadius;
-            y = cy + (dy / dist) * cornerRadius;
-        }
+        input.timeMs = juce::jmax(lastInputTimeMs, now - juce::jlimit(0.0, maxInputAgeMs, age));
+        lastInputTimeMs = input.timeMs;
     }
-    // Bottom-right corner
-    else if (x > width - cornerRadius && y > height - cornerRadius)
-    {
-        float cx = width - cornerRadius;
-        float cy = height - cornerRadius;
-        float dx = x - cx;
-        float dy = y - cy;
-        float dist = std::sqrt(dx * dx + dy * dy);
 
-        if (dist > cornerRadius)
-        {
-            x = cx + (dx / dist) * cornerRadius;
-            y = cy + (dy / dist) * cornerRadius;
-        }
+    simulation.post(input);
+    ++schedulerStats.inputEvents;
+
+    // No repaint here: the clock's next tick draws whatever the samples so
+    // far have done, once per frame however fast the mouse reports
+    wakeAnimation();
+}
+
+void XYControlComponent::advanceAnimation(double timeMs)
+{
+    ++schedulerStats.framesRendered;
+
+    if (!simulation.isRunningOnThread())
+        simulation.advanceTo(timeMs);
+
+    auto previousInputTimeMs = snapshot.latestInputTimeMs;
+
+    if (simulation.readLatest(snapshot) && snapshot.latestInputTimeMs > previousInputTimeMs
+         && schedulerStats.currentRateHz > 0)
+    {
+        // This tick's frame reaches the screen about a frame from now, and
+        // is drawn a step behind the simulation
+        auto latencyMs = (float)(timeMs - snapshot.latestInputTimeMs
+                                 + 1000.0 / schedulerStats.currentRateHz + XYSimulation::stepMs);
+        measuredLatencyMs += (latencyMs - measuredLatencyMs) * (measuredLatencyMs > 0.0f ? 0.1f : 1.0f);
+        simulation.setMeasuredLatency(measuredLatencyMs);
     }
+
+    // Drawn one step behind, between the snapshot's two steps, so it never
+    // has to guess ahead
+    renderAlpha = (float)juce::jlimit(0.0, 1.0, (timeMs - snapshot.stepTimeMs) / XYSimulation::stepMs);
+
+    scheduleNextFrame(snapshot.isSettled);
+}
+
+void XYControlComponent::stepSimulation(int numSteps)
+{
+    simulation.runSteps(numSteps);
+    simulation.readLatest(snapshot);
+    renderAlpha = 1.0f;
+}
+
+void XYControlComponent::flushAnimation()
+{
+    repaintAnimatedRegion();
+}
+
+void XYControlComponent::stepAnimation(double frameMs)
+{
+    advanceAnimation(simulation.getClockTime() + frameMs);
+    flushAnimation();
 }
@@ -2,9 +2,13 @@
 
 #include <juce_gui_extra/juce_gui_extra.h>
 #include <array>
+#include "AnimationClock.h"
+#include "GlowImageCache.h"
+#include "GlowSpriteAtlas.h"
+#include "XYSimulation.h"
 
 class XYControlComponent : public juce::Component,
-                           private juce::Timer
+                           private AnimationClock::Client
 {
 public:
     enum class Preset
@@ -20,8 +24,81 @@ public:
     void setPreset(Preset preset);
     Preset getCurrentPreset() const { return currentPreset; }
 
+    // Tints the glow with any colour; the next setPreset() restores the preset's own
+    void setGlowColour(juce::Colour colour);
+
+    struct FrameSchedulerStats
+    {
+        int currentRateHz = 0;      // 0 while the timer is stopped
+        int64_t framesRendered = 0;
+        int64_t rateChanges = 0;
+        int64_t inputEvents = 0;    // Mouse events, each one a sample, not a repaint
+    };
+
+    FrameSchedulerStats getFrameSchedulerStats() const { return schedulerStats; }
+
+    struct RenderSettings
+    {
+        // Composite into a cached offscreen frame with a pre-baked corner mask,
+        // instead of clipping to a rounded-rectangle path on every paint
+        bool cachedSurface = true;
+
+        // Draw the glow layers with GlowCompositor's SIMD kernels rather than
+        // drawImageTransformed. Needs cachedSurface, which provides the frame.
+        bool simdCompositor = true;
+
+        // Split the composite into tiles shared across GlowCompositor's
+        // worker threads. Off by default: it only pays off on large or
+        // high-DPI surfaces, and the plugin shares the cores with the host.
+        bool tileParallel = false;
+
+        // Draw moving layers from GlowSpriteAtlas's pre-stretched stamps,
+        // translated rather than resampled. Needs simdCompositor. Bins that
+        // aren't rendered yet, and breathing, take the usual path.
+        bool spriteAtlas = false;
+
+        // Max error per pixel, in 8-bit levels. Halving it roughly quadruples
+        // the bins; 16 only shows on a comet moving too fast to see it.
+        float spriteAtlasErrorBudget = 16.0f;
+    };
+
+    void setRenderSettings(const RenderSettings& newSettings);
+    const RenderSettings& getRenderSettings() const { return renderSettings; }
+
+    // Zeros unless RenderSettings::spriteAtlas is on
+    GlowSpriteAtlas::Stats getSpriteAtlasStats() const;
+
+    // Runs one animation frame frameMs after the last one, as if the clock
+    // had ticked. For offline rendering (RenderBenchmark) where nothing ticks.
+    void stepAnimation(double frameMs);
+
+    // The motion runs in XYSimulation, on its own thread while the pad is
+    // showing, in whole steps so the same input gives the same motion at any
+    // display rate; paint() interpolates between the last two. Without the
+    // thread each clock tick (or stepAnimation()) steps it instead, and this
+    // runs numSteps directly, for tests.
+    void stepSimulation(int numSteps);
+    const XYSimulation::Snapshot& getSimulationSnapshot() const { return snapshot; }
+
+    // Off by default. With leadMs at 0 it leads by the latency measured from
+    // mouse sample to frame; snapshot.prediction has how well it's doing.
+    void setPrediction(const XYSimulation::Prediction& prediction) { simulation.setPrediction(prediction); }
+    float getMeasuredLatencyMs() const { return measuredLatencyMs; }
+
+    // Moves the target as if dragged there but without a press, for host
+    // automation. x and y are 0..1 across and down the pad.
+    void setTarget(juce::Point<float> target);
+
+    // Called on the message thread as the user drags the pad, with the same
+    // 0..1 target the simulation gets
+    std::function<void()> onDragStart;
+    std::function<void(juce::Point<float>)> onTargetChanged;
+    std::function<void()> onDragEnd;
+
     void paint(juce::Graphics&) override;
     void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
 
     void mouseDown(const juce::MouseEvent& event) override;
     void mouseDrag(const juce::MouseEvent& event) override;
@@ -29,41 +106,8 @@ public:
     void mouseDoubleClick(const juce::MouseEvent& event) override;
 
 private:
-    void timerCallback() override;
-
-    struct SpringLayer
-    {
-        float x, y;
-        float vx, vy;
-        float stiffness, damping, mass;
-
-        SpringLayer(float stiff, float damp, float m)
-            : x(0.5f), y(0.5f), vx(0), vy(0),
-              stiffness(stiff), damping(damp), mass(m) {}
-
-        void update(float targetX, float targetY, float dt)
-        {
-            // Spring force
-            float fx = (targetX - x) * stiffness;
-            float fy = (targetY - y) * stiffness;
-
-            // Damping force
-            float dampingFx = vx * damping;
-            float dampingFy = vy * damping;
-
-            // Acceleration
-            float ax = (fx - dampingFx) / mass;
-            float ay = (fy - dampingFy) / mass;
-
-            // Velocity
-            vx += ax * dt;
-            vy += ay * dt;
-
-            // Position
-            x += vx * dt;
-            y += vy * dt;
-        }
-    };
+    void advanceAnimation(double timeMs) override;
+    void flushAnimation() override;
 
     struct GlowLayer
     {
@@ -71,29 +115,89 @@ private:
         float opacity;
         juce::Colour color;
         juce::Image cachedImage;
+        GlowCompositor::Mask compositorMask;    // Only with simdCompositor
     };
 
-    std::array<SpringLayer, 6> springLayers;
-    std::array<GlowLayer, 5> glowLayers;
+    struct LayerTransform
+    {
+        juce::AffineTransform transform;
+        float opacity = 1.0f;
+    };
 
-    float targetX = 0.5f;
-    float targetY = 0.5f;
-    bool isDragging = false;
-    int64_t lastFrameTime;
-    float idleTimer = 0.0f;
-    bool isBreathing = true;
-    float breatheTime = 0.0f;
-    float breatheBlend = 0.0f;  // Smooth transition into breathing
-    bool isDispersing = false;
-    float disperseTime = 0.0f;
+    struct LayerMotion
+    {
+        bool isMoving = false;
+        float speedFactor = 0.0f;   // 0..1, how far into the comet shape
+        float angle = 0.0f;
+    };
+
+    std::array<GlowLayer, XYSimulation::numLayers - 1> glowLayers;
+
+    XYSimulation simulation;
+    XYSimulation::Snapshot snapshot;    // Latest taken, what paint() draws
+    float renderAlpha = 1.0f;           // Between the snapshot's two steps
+    double lastInputTimeMs = 0.0;
+    float measuredLatencyMs = 0.0f;     // Smoothed, mouse sample to the frame showing it
+
+    // Event times are only to the millisecond and from another clock, so
+    // anything claiming to be older than this is taken as this old
+    static constexpr double maxInputAgeMs = 50.0;
 
     Preset currentPreset = Preset::Blue;
     juce::Colour backgroundColor;
     juce::Colour cursorColor;
 
-    void loadGlowImagesFromBinaryData();
+    // Tick rates for the frame scheduler
+    static constexpr int activeFrameRateHz = 60;
+    static constexpr int breathingFrameRateHz = 30;
+    static constexpr int settledFrameRateHz = 4;
+    FrameSchedulerStats schedulerStats;
+    juce::SharedResourcePointer<AnimationClock> animationClock;
+    juce::SharedResourcePointer<GlowImageCache> glowImageCache;
+    juce::SharedResourcePointer<GlowCompositor::WorkerPool> compositorWorkers;
+
+    // Physical pixels per logical pixel the masks were rendered for
+    float glowMaskScale = 1.0f;
+    std::unique_ptr<GlowSpriteAtlas> spriteAtlas;   // Only with RenderSettings::spriteAtlas
+
+    static constexpr float cornerRadius = 24.0f;
+    RenderSettings renderSettings;
+
+    // Offscreen frame the surface is composited into, and the rounded
+    // rectangle's coverage, both at surfaceScale. The four corner squares are
+    // the only places the coverage isn't 255.
+    juce::Image surfaceFrame;
+    juce::Image surfaceCoverage;
+    float surfaceScale = 0.0f;
+    std::array<juce::Rectangle<int>, 4> surfaceCorners;
+
+    // Area repainted last frame, so the glow's old position gets cleared
+    juce::Rectangle<int> lastAnimatedBounds;
+
+    void loadGlowImages();
     void updateColorsForPreset();
     void constrainToRoundedBounds(float& x, float& y, float width, float height, float cornerRadius);
 
+    LayerMotion getLayerMotion(int layerIndex) const;
+    GlowSpriteAtlas::CometShape getCometShape(int layerIndex) const;
+    LayerTransform getLayerTransform(int layerIndex, juce::Rectangle<int> bounds) const;
+    juce::Rectangle<float> getCursorBounds(juce::Rectangle<int> bounds) const;
+    juce::Rectangle<int> getAnimatedBounds() const;
+    void repaintAnimatedRegion();
+
+    void paintClippedSurface(juce::Graphics& g, juce::Rectangle<int> bounds);
+    void paintCachedSurface(juce::Graphics& g, juce::Rectangle<int> bounds, float scale);
+    void paintGlowLayers(juce::Graphics& g, juce::Rectangle<int> bounds);
+    void paintCursor(juce::Graphics& g, juce::Rectangle<int> bounds);
+    void compositeGlowLayers(juce::Rectangle<int> dirty, juce::Rectangle<int> bounds, float scale);
+    void updateSurface(float scale);
+    void applyCornerCoverage(juce::Rectangle<int> dirty);
+
+    void setFrameRate(int rateHz);
+    void wakeAnimation();
+    void scheduleNextFrame(bool isSettled);
+    void updateSimulationThread();
+    void postInput(XYSimulation::Input input, const juce::MouseEvent& event);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(XYControlComponent)
 };
@@ -0,0 +1,278 @@
+#include "XYEffect.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <immintrin.h>
+ #define XYEFFECT_SSE 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define XYEFFECT_NEON 1
+#endif
+
+namespace
+{
+    // Each side of centre sweeps its filter over this range
+    constexpr float lowPassFrom = 40.0f, lowPassTo = 20000.0f;
+    constexpr float highPassFrom = 20.0f, highPassTo = 10000.0f;
+
+    // Either side of the centre the filter's bypassed, and beyond that it
+    // fades in, so it switches between low- and high-pass unheard
+    constexpr float bypassWidth = 0.04f;
+    constexpr float fadeWidth = 0.04f;
+
+    constexpr float maxDrive = 16.0f;       // Gain into the clipper at the top, 24 dB
+    constexpr float panDepth = 0.5f;        // Of the way to hard left or right, at the pad's edges
+
+    // No fused multiply-adds below, as in SpringPhysics::integrate(), so the
+    // scalar tail matches the vectors
+
+    // destination[i] = from + delta * (first + i)
+    void fillRamp(float* destination, float from, float delta, int first, int numSamples)
+    {
+        int i = 0;
+
+       #if XYEFFECT_SSE
+        const __m128 start = _mm_set1_ps(from), step = _mm_set1_ps(delta), four = _mm_set1_ps(4.0f);
+        __m128 index = _mm_add_ps(_mm_set1_ps((float)first), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+
+        for (; i + 4 <= numSamples; i += 4, index = _mm_add_ps(index, four))
+            _mm_storeu_ps(destination + i, _mm_add_ps(start, _mm_mul_ps(step, index)));
+       #elif XYEFFECT_NEON
+        const float32x4_t start = vdupq_n_f32(from), step = vdupq_n_f32(delta), four = vdupq_n_f32(4.0f);
+        const float lanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        float32x4_t index = vaddq_f32(vdupq_n_f32((float)first), vld1q_f32(lanes));
+
+        for (; i + 4 <= numSamples; i += 4, index = vaddq_f32(index, four))
+            vst1q_f32(destination + i, vaddq_f32(start, vmulq_f32(step, index)));
+       #endif
+
+        for (; i < numSamples; ++i)
+            destination[i] = from + delta * (float)(first + i);
+    }
+
+    // tanh to within 2.5%, and exactly 1 from 3 on: v (27 + v^2) / (27 + 9 v^2)
+    // on v clamped to +-3, blended with the dry sample by mix
+    void applyDrive(float* samples, const float* gain, const float* makeup, const float* mix, int numSamples)
+    {
+        int i = 0;
+
+       #if XYEFFECT_SSE
+        const __m128 limit = _mm_set1_ps(3.0f), negativeLimit = _mm_set1_ps(-3.0f);
+        const __m128 c27 = _mm_set1_ps(27.0f), c9 = _mm_set1_ps(9.0f);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            __m128 dry = _mm_loadu_ps(samples + i);
+            __m128 v = _mm_min_ps(limit, _mm_max_ps(negativeLimit, _mm_mul_ps(dry, _mm_loadu_ps(gain + i))));
+            __m128 v2 = _mm_mul_ps(v, v);
+            __m128 clipped = _mm_div_ps(_mm_mul_ps(v, _mm_add_ps(c27, v2)), _mm_add_ps(c27, _mm_mul_ps(c9, v2)));
+            __m128 wet = _mm_mul_ps(clipped, _mm_loadu_ps(makeup + i));
+            _mm_storeu_ps(samples + i, _mm_add_ps(dry, _mm_mul_ps(_mm_loadu_ps(mix + i), _mm_sub_ps(wet, dry))));
+        }
+       #elif XYEFFECT_NEON
+        const float32x4_t limit = vdupq_n_f32(3.0f), negativeLimit = vdupq_n_f32(-3.0f);
+        const float32x4_t c27 = vdupq_n_f32(27.0f), c9 = vdupq_n_f32(9.0f);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            float32x4_t dry = vld1q_f32(samples + i);
+            float32x4_t v = vminq_f32(limit, vmaxq_f32(negativeLimit, vmulq_f32(dry, vld1q_f32(gain + i))));
+            float32x4_t v2 = vmulq_f32(v, v);
+            float32x4_t clipped = vdivq_f32(vmulq_f32(v, vaddq_f32(c27, v2)), vaddq_f32(c27, vmulq_f32(c9, v2)));
+            float32x4_t wet = vmulq_f32(clipped, vld1q_f32(makeup + i));
+            vst1q_f32(samples + i, vaddq_f32(dry, vmulq_f32(vld1q_f32(mix + i), vsubq_f32(wet, dry))));
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            float dry = samples[i];
+            float v = juce::jmin(3.0f, juce::jmax(-3.0f, dry * gain[i]));
+            float v2 = v * v;
+            float wet = (v * (27.0f + v2)) / (27.0f + 9.0f * v2) * makeup[i];
+            samples[i] = dry + mix[i] * (wet - dry);
+        }
+    }
+
+    // Mid/side with the side scaled by width, then each side by its pan gain
+    void applyWidthAndPan(float* left, float* right, const float* width,
+                          const float* panLeft, const float* panRight, int numSamples)
+    {
+        int i = 0;
+
+       #if XYEFFECT_SSE
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            __m128 l = _mm_loadu_ps(left + i), r = _mm_loadu_ps(right + i);
+            __m128 mid = _mm_mul_ps(_mm_add_ps(l, r), half);
+            __m128 side = _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(l, r), half), _mm_loadu_ps(width + i));
+            _mm_storeu_ps(left + i, _mm_mul_ps(_mm_add_ps(mid, side), _mm_loadu_ps(panLeft + i)));
+            _mm_storeu_ps(right + i, _mm_mul_ps(_mm_sub_ps(mid, side), _mm_loadu_ps(panRight + i)));
+        }
+       #elif XYEFFECT_NEON
+        const float32x4_t half = vdupq_n_f32(0.5f);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            float32x4_t l = vld1q_f32(left + i), r = vld1q_f32(right + i);
+            float32x4_t mid = vmulq_f32(vaddq_f32(l, r), half);
+            float32x4_t side = vmulq_f32(vmulq_f32(vsubq_f32(l, r), half), vld1q_f32(width + i));
+            vst1q_f32(left + i, vmulq_f32(vaddq_f32(mid, side), vld1q_f32(panLeft + i)));
+            vst1q_f32(right + i, vmulq_f32(vsubq_f32(mid, side), vld1q_f32(panRight + i)));
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            float mid = (left[i] + right[i]) * 0.5f;
+            float side = (left[i] - right[i]) * 0.5f * width[i];
+            left[i] = (mid + side) * panLeft[i];
+            right[i] = (mid - side) * panRight[i];
+        }
+    }
+}
+
+//==============================================================================
+void XYEffect::prepare(double newSampleRate, int maxBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    for (auto& ramp : ramps)
+        ramp.assign((size_t)maxBlockSize, 0.0f);
+
+    reset(0.5f, 0.5f);
+}
+
+void XYEffect::reset(float x, float y)
+{
+    from = to = getControls(x, y);
+    samplesToControl = 0;
+    filters = {};
+}
+
+XYEffect::Controls XYEffect::getControls(float x, float y) const
+{
+    Controls controls;
+
+    bool isHighPass = x >= 0.5f;
+    float fromCentre = std::abs(x - 0.5f);
+    float sweep = isHighPass ? juce::jmax(0.0f, fromCentre - bypassWidth) / (0.5f - bypassWidth)
+                             : juce::jmin(1.0f, x / (0.5f - bypassWidth));
+    float cutoff = isHighPass ? highPassFrom * std::pow(highPassTo / highPassFrom, sweep)
+                              : lowPassFrom * std::pow(lowPassTo / lowPassFrom, sweep);
+    cutoff = juce::jmin(cutoff, 0.45f * (float)sampleRate);
+
+    // The filter's coefficients themselves are what get ramped, so there's
+    // no division per sample
+    float g = std::tan(juce::MathConstants<float>::pi * cutoff / (float)sampleRate);
+    controls[filterA1] = 1.0f / (1.0f + g * (g + filterK));
+    controls[filterA2] = g * controls[filterA1];
+    controls[filterA3] = g * controls[filterA2];
+    controls[highPassMix] = isHighPass ? 1.0f : 0.0f;
+    controls[filterMix] = juce::jlimit(0.0f, 1.0f, (fromCentre - bypassWidth) / fadeWidth);
+
+    float drive = juce::jmax(0.0f, (y - 0.5f) * 2.0f);
+    controls[driveGain] = 1.0f + (maxDrive - 1.0f) * drive * drive;
+    controls[driveMakeup] = 1.0f / std::sqrt(controls[driveGain]);
+    controls[driveMix] = drive;
+
+    controls[width] = juce::jmin(1.0f, y * 2.0f);
+
+    // Equal power, scaled to unity in the middle so the centre is untouched
+    float angle = (1.0f + (x - 0.5f) * 2.0f * panDepth) * juce::MathConstants<float>::pi * 0.25f;
+    controls[panLeft] = juce::MathConstants<float>::sqrt2 * std::cos(angle);
+    controls[panRight] = juce::MathConstants<float>::sqrt2 * std::sin(angle);
+
+    return controls;
+}
+
+void XYEffect::fillControls(const float* x, const float* y, int numSamples)
+{
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        if (samplesToControl == 0)
+        {
+            from = to;
+            to = getControls(x[done], y[done]);
+            samplesToControl = controlInterval;
+        }
+
+        // Worked out from the control point rather than accumulated, so a
+        // ramp split across blocks comes out the same as one that isn't
+        int run = juce::jmin(samplesToControl, numSamples - done);
+        int first = controlInterval - samplesToControl + 1;
+
+        for (size_t c = 0; c < numControls; ++c)
+            fillRamp(ramps[c].data() + done, from[c], (to[c] - from[c]) / (float)controlInterval, first, run);
+
+        done += run;
+        samplesToControl -= run;
+    }
+}
+
+//==============================================================================
+void XYEffect::process(float* const* channels, int numChannels, int numSamples, const float* x, const float* y)
+{
+    jassert(numSamples <= (int)ramps[0].size() && numChannels <= 2);
+
+    numChannels = juce::jmin(numChannels, 2);
+    fillControls(x, y, numSamples);
+
+    // Filter: the recursion is serial, so both channels share the loop. The
+    // state stays in locals, which the writes to the channels can't alias.
+    {
+        const float* a1 = ramps[filterA1].data();
+        const float* a2 = ramps[filterA2].data();
+        const float* a3 = ramps[filterA3].data();
+        const float* mix = ramps[highPassMix].data();
+        const float* wet = ramps[filterMix].data();
+        float* left = channels[0];
+        float* right = numChannels > 1 ? channels[1] : nullptr;
+
+        float l1 = filters[0].ic1, l2 = filters[0].ic2;
+        float r1 = filters[1].ic1, r2 = filters[1].ic2;
+
+        auto tick = [](float& ic1, float& ic2, float v0, float k1, float k2, float k3, float highPass, float filtered)
+        {
+            float v3 = v0 - ic2;
+            float v1 = k1 * ic1 + k2 * v3;
+            float v2 = ic2 + k2 * ic1 + k3 * v3;
+            ic1 = 2.0f * v1 - ic1;
+            ic2 = 2.0f * v2 - ic2;
+
+            float highOut = v0 - filterK * v1 - v2;
+            float out = v2 + highPass * (highOut - v2);
+            return v0 + filtered * (out - v0);
+        };
+
+        if (right != nullptr)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float outLeft = tick(l1, l2, left[i], a1[i], a2[i], a3[i], mix[i], wet[i]);
+                float outRight = tick(r1, r2, right[i], a1[i], a2[i], a3[i], mix[i], wet[i]);
+                left[i] = outLeft;
+                right[i] = outRight;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                left[i] = tick(l1, l2, left[i], a1[i], a2[i], a3[i], mix[i], wet[i]);
+        }
+
+        filters[0] = { l1, l2 };
+        filters[1] = { r1, r2 };
+    }
+
+    // Drive, blended in from nothing at the centre
+    for (int ch = 0; ch < numChannels; ++ch)
+        applyDrive(channels[ch], ramps[driveGain].data(), ramps[driveMakeup].data(), ramps[driveMix].data(), numSamples);
+
+    if (numChannels == 2)
+        applyWidthAndPan(channels[0], channels[1], ramps[width].data(),
+                         ramps[panLeft].data(), ramps[panRight].data(), numSamples);
+}
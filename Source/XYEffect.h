@@ -0,0 +1,75 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+
+// The plugin's built-in effect, played from the pad. Left of centre X closes
+// a low-pass from 20 kHz, right of it opens a high-pass from 20 Hz, and it
+// pans a little towards its side; above centre Y drives a soft clipper,
+// below it narrows the stereo image to mono. Round the centre the filter is
+// bypassed, so the centre leaves the sound as it is.
+//
+// The X/Y curves come in per sample (XYModulator). Everything that takes a
+// tan, pow or cos - filter coefficients, gains - is worked out every
+// controlInterval samples, counted across blocks so the result doesn't
+// depend on the block size, and ramped per sample in between. Each stage
+// then runs over the whole block: the stateless ones (the ramps, the drive,
+// width and pan) as SSE or NEON kernels, and the filter's recursion, which
+// is serial, with both channels in the same loop.
+//
+// Allocates only in prepare().
+class XYEffect
+{
+public:
+    void prepare(double sampleRate, int maxBlockSize);
+
+    // Clears the filter and jumps the controls straight to x, y
+    void reset(float x, float y);
+
+    // Processes numSamples of up to two channels in place, no more than
+    // prepare()'s maxBlockSize, with x and y (0..1, y up) for each sample
+    void process(float* const* channels, int numChannels, int numSamples, const float* x, const float* y);
+
+    static constexpr int controlInterval = 16;
+
+private:
+    // Everything per sample the stages need, ramped between control points
+    enum Control
+    {
+        filterA1,           // The state variable filter's coefficients
+        filterA2,
+        filterA3,
+        highPassMix,        // 0 low-pass, 1 high-pass; switches where the filter's bypassed
+        filterMix,          // 0 bypassed, round the centre, 1 filtered
+        driveGain,
+        driveMakeup,
+        driveMix,
+        width,              // 1 as it is, 0 mono
+        panLeft,
+        panRight,
+        numControls
+    };
+
+    using Controls = std::array<float, numControls>;
+
+    Controls getControls(float x, float y) const;
+    void fillControls(const float* x, const float* y, int numSamples);
+
+    double sampleRate = 48000.0;
+
+    Controls from {}, to {};        // At the last control point and the next
+    int samplesToControl = 0;       // Until the next one
+
+    std::array<std::vector<float>, numControls> ramps;
+
+    // Topology-preserving state variable filter, one per channel
+    struct FilterState
+    {
+        float ic1 = 0.0f, ic2 = 0.0f;
+    };
+
+    std::array<FilterState, 2> filters;
+
+    static constexpr float filterK = 1.0f / 0.8f;    // 1 / Q: a touch over Butterworth
+};
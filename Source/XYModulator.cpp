@@ -0,0 +1,107 @@
+#include "XYModulator.h"
+#include "XYSimulation.h"
+
+XYModulator::XYModulator()
+{
+    cursor = springs.addCursor(XYSimulation::cursorSpring, {}, { 0.5f, 0.5f });
+    previous = current = springs.getState(cursor, 0);
+}
+
+void XYModulator::prepare(double sampleRate)
+{
+    jassert(sampleRate > 0.0);
+
+    // At least a sample a step, so process() always gets through its steps
+    samplesPerStep = juce::jmax(1.0, sampleRate * XYSimulation::stepMs / 1000.0);
+    samplesIntoStep = 0.0;
+}
+
+void XYModulator::reset(juce::Point<float> position)
+{
+    // Only the lead's state is public, so rebuild the springs at position.
+    // Not real-time safe; call it from prepareToPlay() or the like.
+    springs = {};
+    cursor = springs.addCursor(XYSimulation::cursorSpring, {}, position);
+
+    previous = current = springs.getState(cursor, 0);
+    lastPosition = position;
+    samplesIntoStep = 0.0;
+}
+
+void XYModulator::setTarget(float x, float y)
+{
+    springs.setTarget(cursor, x, y);
+}
+
+void XYModulator::step()
+{
+    springs.step(XYSimulation::springStep);
+
+    previous = current;
+    current = springs.getState(cursor, 0);
+}
+
+void XYModulator::fillRamp(float* destination, float from, float to, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    float delta = (to - from) / (float)numSamples;
+
+    for (int i = 0; i < numSamples - 1; ++i)
+        destination[i] = from + delta * (float)(i + 1);
+
+    // Not left to rounding: the next block starts from exactly here
+    destination[numSamples - 1] = to;
+}
+
+void XYModulator::process(float* x, float* y, int numSamples)
+{
+    process(nullptr, nullptr, x, y, numSamples);
+}
+
+void XYModulator::process(const float* targetX, const float* targetY, float* x, float* y, int numSamples)
+{
+    const double stepsPerSample = 1.0 / samplesPerStep;
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        if (samplesIntoStep >= samplesPerStep)
+        {
+            samplesIntoStep -= samplesPerStep;
+
+            if (targetX != nullptr)
+                springs.setTarget(cursor, targetX[done], targetY[done]);
+
+            step();
+        }
+
+        // Up to the next step, where the ramp changes slope; every sample
+        // in the run stays under it, so alpha stays under 1
+        int run = juce::jmin(numSamples - done, (int)std::ceil(samplesPerStep - samplesIntoStep));
+
+        float alpha = (float)(samplesIntoStep * stepsPerSample);
+        float dAlpha = (float)stepsPerSample;
+        float dx = current.x - previous.x;
+        float dy = current.y - previous.y;
+
+        if (x != nullptr)
+            for (int i = 0; i < run; ++i)
+                x[done + i] = previous.x + dx * (alpha + (float)i * dAlpha);
+
+        if (y != nullptr)
+            for (int i = 0; i < run; ++i)
+                y[done + i] = previous.y + dy * (alpha + (float)i * dAlpha);
+
+        float last = alpha + (float)(run - 1) * dAlpha;
+        lastPosition = { previous.x + dx * last, previous.y + dy * last };
+
+        done += run;
+        samplesIntoStep += run;
+    }
+
+    // Where the ramp ended, for the next block's steps
+    if (targetX != nullptr && numSamples > 0)
+        springs.setTarget(cursor, targetX[numSamples - 1], targetY[numSamples - 1]);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "SpringPhysics.h"
+
+// The pad's cursor spring, run on the audio thread so whatever the pad
+// modulates glides the way the cursor does, whether or not the editor is
+// open. It steps in the simulation's fixed steps, counted in samples at the
+// real sample rate, and ramps linearly between the last two steps sample by
+// sample, so a 240 Hz spring still gives a zipper-free per-sample curve.
+//
+// Same spring and step as XYSimulation's cursor, so given the same targets
+// the two trace the same path. The pad draws its own rather than reading
+// this one, so it keeps moving while the host isn't processing, but it
+// isn't given the same targets: it follows the mouse, led ahead when
+// prediction is on, and automation only at the editor's 30 Hz poll, while
+// this ramps the parameters per block. What's drawn can be up to a block
+// and the lead away from what's heard.
+//
+// Everything is set up in the constructor and prepare(): process() never
+// allocates or locks.
+class XYModulator
+{
+public:
+    XYModulator();
+
+    void prepare(double sampleRate);
+
+    // Jumps straight to position, at rest, e.g. when playback starts
+    void reset(juce::Point<float> position);
+
+    // Where the spring heads from the next step on, 0..1
+    void setTarget(float x, float y);
+
+    // Writes numSamples of the smoothed position; either may be nullptr
+    void process(float* x, float* y, int numSamples);
+
+    // The same, with the target moving sample by sample: each step takes it
+    // from its own sample, so automation lands where it falls in the block
+    // rather than at the block's start. The target stays at the last value.
+    void process(const float* targetX, const float* targetY, float* x, float* y, int numSamples);
+
+    // numSamples of a straight line from from (the sample before) to exactly
+    // to on the last sample: one block of automation between two values
+    static void fillRamp(float* destination, float from, float to, int numSamples);
+
+    // As of the last sample written
+    juce::Point<float> getPosition() const { return lastPosition; }
+
+private:
+    void step();
+
+    SpringPhysics springs;
+    int cursor = 0;
+
+    double samplesPerStep = 200.0;  // 48 kHz until prepared
+    double samplesIntoStep = 0.0;   // Since the last step, under samplesPerStep
+
+    SpringPhysics::State previous {}, current {};
+    juce::Point<float> lastPosition { 0.5f, 0.5f };
+};
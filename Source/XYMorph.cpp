@@ -0,0 +1,136 @@
+#include "XYMorph.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <immintrin.h>
+ #define XYMORPH_SSE 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define XYMORPH_NEON 1
+#endif
+
+void XYMorph::setNumParameters(int newNumParameters)
+{
+    numParameters = juce::jmax(0, newNumParameters);
+
+    // Padding never moves: 0 at every corner, and already reported as 0
+    auto padded = (size_t)((numParameters + vectorSize - 1) / vectorSize * vectorSize);
+
+    for (auto& corner : corners)
+        corner.assign(padded, 0.0f);
+
+    values.assign(padded, 0.0f);
+    reported.assign(padded, 0.0f);
+    changes.assign(padded, 0);
+    reportAll = true;
+}
+
+void XYMorph::setCorner(int corner, const float* snapshot)
+{
+    jassert(corner >= 0 && corner < numCorners);
+    std::copy(snapshot, snapshot + numParameters, corners[(size_t)corner].begin());
+}
+
+//==============================================================================
+// No fused multiply-adds on the vector paths, as in SpringPhysics::integrate()
+int XYMorph::process(float x, float y)
+{
+    x = juce::jlimit(0.0f, 1.0f, x);
+    y = juce::jlimit(0.0f, 1.0f, y);
+
+    // Each corner's share; exactly 1 on the corner itself
+    const float weights[numCorners] = { (1.0f - x) * (1.0f - y), x * (1.0f - y),
+                                        (1.0f - x) * y,          x * y };
+
+    const float* bl = corners[bottomLeft].data();
+    const float* br = corners[bottomRight].data();
+    const float* tl = corners[topLeft].data();
+    const float* tr = corners[topRight].data();
+    float* out = values.data();
+    float* last = reported.data();
+    int* indices = changes.data();
+
+    int numChanges = 0;
+    auto size = (int)values.size();
+
+   #if XYMORPH_SSE || XYMORPH_NEON
+    // One bit per lane that changed, from first on. Every lane's index is
+    // written, but only those that changed are kept.
+    auto addChanges = [&](int first, unsigned bits)
+    {
+        for (int lane = 0; lane < vectorSize; ++lane)
+        {
+            indices[numChanges] = first + lane;
+            numChanges += (int)((bits >> lane) & 1u);
+        }
+    };
+   #endif
+
+   #if XYMORPH_SSE
+    const __m128 wbl = _mm_set1_ps(weights[bottomLeft]), wbr = _mm_set1_ps(weights[bottomRight]);
+    const __m128 wtl = _mm_set1_ps(weights[topLeft]), wtr = _mm_set1_ps(weights[topRight]);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 limit = _mm_set1_ps(threshold);
+    const __m128 all = _mm_castsi128_ps(_mm_set1_epi32(reportAll ? -1 : 0));
+
+    for (int i = 0; i < size; i += vectorSize)
+    {
+        __m128 value = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(bl + i), wbl),
+                                                        _mm_mul_ps(_mm_loadu_ps(br + i), wbr)),
+                                             _mm_mul_ps(_mm_loadu_ps(tl + i), wtl)),
+                                  _mm_mul_ps(_mm_loadu_ps(tr + i), wtr));
+        _mm_storeu_ps(out + i, value);
+
+        __m128 previous = _mm_loadu_ps(last + i);
+        __m128 changed = _mm_or_ps(all, _mm_cmpgt_ps(_mm_and_ps(_mm_sub_ps(value, previous), absMask), limit));
+
+        if (auto bits = (unsigned)_mm_movemask_ps(changed))
+        {
+            _mm_storeu_ps(last + i, _mm_or_ps(_mm_and_ps(changed, value), _mm_andnot_ps(changed, previous)));
+            addChanges(i, bits);
+        }
+    }
+   #elif XYMORPH_NEON
+    const float32x4_t wbl = vdupq_n_f32(weights[bottomLeft]), wbr = vdupq_n_f32(weights[bottomRight]);
+    const float32x4_t wtl = vdupq_n_f32(weights[topLeft]), wtr = vdupq_n_f32(weights[topRight]);
+    const float32x4_t limit = vdupq_n_f32(threshold);
+    const uint32x4_t all = vdupq_n_u32(reportAll ? 0xffffffffu : 0u);
+    const uint32_t lanes[vectorSize] = { 1, 2, 4, 8 };
+    const uint32x4_t laneBits = vld1q_u32(lanes);
+
+    for (int i = 0; i < size; i += vectorSize)
+    {
+        // No vfma, as above
+        float32x4_t value = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(vld1q_f32(bl + i), wbl),
+                                                          vmulq_f32(vld1q_f32(br + i), wbr)),
+                                                vmulq_f32(vld1q_f32(tl + i), wtl)),
+                                      vmulq_f32(vld1q_f32(tr + i), wtr));
+        vst1q_f32(out + i, value);
+
+        float32x4_t previous = vld1q_f32(last + i);
+        uint32x4_t changed = vorrq_u32(all, vcgtq_f32(vabsq_f32(vsubq_f32(value, previous)), limit));
+
+        if (auto bits = (unsigned)vaddvq_u32(vandq_u32(changed, laneBits)))
+        {
+            vst1q_f32(last + i, vbslq_f32(changed, value, previous));
+            addChanges(i, bits);
+        }
+    }
+   #else
+    for (int i = 0; i < size; ++i)
+    {
+        out[i] = ((bl[i] * weights[bottomLeft] + br[i] * weights[bottomRight])
+                   + tl[i] * weights[topLeft]) + tr[i] * weights[topRight];
+
+        if (reportAll || std::abs(out[i] - last[i]) > threshold)
+        {
+            last[i] = out[i];
+            indices[numChanges++] = i;
+        }
+    }
+   #endif
+
+    // Padding only ever changes with reportAll, and comes last
+    reportAll = false;
+    return juce::jmin(numChanges, numParameters);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+
+// Morphs a set of parameters between four snapshots of them, one at each
+// corner of the pad, blending bilinearly by X and Y. The snapshots are kept
+// as parallel arrays, one per corner, padded to whole vectors, and blended
+// four parameters at a time with SSE or NEON, so hundreds of them cost next
+// to nothing per call.
+//
+// Each call also works out which values have moved by more than threshold
+// since they were last reported, in the same pass, so the caller only
+// passes those on (to a host, say) rather than every value every time.
+//
+// Allocates only in setNumParameters().
+class XYMorph
+{
+public:
+    enum Corner { bottomLeft, bottomRight, topLeft, topRight, numCorners };
+
+    // Every corner starts at 0
+    void setNumParameters(int newNumParameters);
+    int getNumParameters() const { return numParameters; }
+
+    // getNumParameters() values
+    void setCorner(int corner, const float* snapshot);
+
+    // Blends the corners for x and y (0..1, y up) and returns how many values
+    // have changed. The first call after setNumParameters() or resync()
+    // reports them all.
+    int process(float x, float y);
+
+    const float* getValues() const { return values.data(); }
+
+    // Indices of the values process() reported, in order
+    const int* getChanges() const { return changes.data(); }
+
+    // Reports every value on the next process(), for when whatever they go
+    // to may no longer have them
+    void resync() { reportAll = true; }
+
+    // Small enough that nobody hears or sees the difference, large enough
+    // that a slow drag doesn't send every value every time
+    static constexpr float threshold = 1.0f / 4096.0f;
+
+    static constexpr int vectorSize = 4;
+
+private:
+    int numParameters = 0;
+
+    std::array<std::vector<float>, numCorners> corners;
+    std::vector<float> values;
+    std::vector<float> reported;        // As of the last time each was reported
+    std::vector<int> changes;
+    bool reportAll = true;
+};
@@ -0,0 +1,434 @@
+#include "XYSimulation.h"
+#include <limits>
+
+SpringPhysics::State XYSimulation::Snapshot::getState(int layer, float alpha) const
+{
+    auto& from = previous[(size_t)layer];
+    auto& to = current[(size_t)layer];
+
+    if (alpha >= 1.0f)
+        return to;
+
+    auto blend = [alpha](float a, float b) { return a + (b - a) * alpha; };
+    return { blend(from.x, to.x), blend(from.y, to.y), blend(from.vx, to.vx), blend(from.vy, to.vy) };
+}
+
+//==============================================================================
+XYSimulation::XYSimulation()
+    : juce::Thread("XY simulation")
+{
+    cursor = springs.addCursor(cursorSpring,
+                               { { 0.09f, 0.88f, 3.8f },    // inner
+                                 { 0.07f, 0.85f, 5.2f },    // mid
+                                 { 0.05f, 0.82f, 6.8f },    // outer
+                                 { 0.04f, 0.78f, 8.5f },    // ambient
+                                 { 0.03f, 0.75f, 10.5f } }, // atmosphere
+                               { 0.5f, 0.5f });
+
+    jassert(springs.getNumLayers(cursor) == numLayers);
+
+    lastTimeMs = juce::Time::getMillisecondCounterHiRes();
+    publish();
+}
+
+XYSimulation::~XYSimulation()
+{
+    stopThread(1000);
+}
+
+void XYSimulation::post(const Input& input)
+{
+    // Only fills up if the simulation has stopped stepping, and then the
+    // newest input is the one to lose
+    auto scope = inputFifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        inputs[(size_t)scope.startIndex1] = input;
+
+    notify();
+}
+
+void XYSimulation::setPrediction(const Prediction& newPrediction)
+{
+    predictionSettings.getWriteBuffer() = newPrediction;
+    predictionSettings.publish();
+}
+
+bool XYSimulation::readLatest(Snapshot& snapshot)
+{
+    if (!snapshots.acquire())
+        return false;
+
+    snapshot = snapshots.getReadBuffer();
+    return true;
+}
+
+void XYSimulation::setThreadRunning(bool shouldRun)
+{
+    if (shouldRun == isThreadRunning())
+        return;
+
+    if (shouldRun)
+    {
+        // Don't simulate however long it was stopped for
+        lastTimeMs = juce::Time::getMillisecondCounterHiRes();
+        startThread(juce::Thread::Priority::high);
+    }
+    else
+    {
+        stopThread(1000);
+    }
+}
+
+//==============================================================================
+void XYSimulation::run()
+{
+    while (!threadShouldExit())
+    {
+        advanceTo(juce::Time::getMillisecondCounterHiRes());
+        wait(getWaitMs());
+    }
+}
+
+int XYSimulation::getWaitMs() const
+{
+    auto untilNextStep = (int)std::ceil(stepMs - accumulatorMs);
+
+    // Nothing moves while it's settled, so the only time it needs waking
+    // before there's input is to start breathing, and to keep breathing fresh
+    if (inputFifo.getNumReady() > 0 || !isSettled || (breatheBlend > 0.0f && !isBreathing))
+        return juce::jmax(1, untilNextStep);
+
+    if (isBreathing)
+        return 16;
+
+    return juce::jmax(1, (int)std::ceil(500.0f - idleTimer) + 1);
+}
+
+void XYSimulation::advanceTo(double timeMs)
+{
+    double elapsedMs = juce::jlimit(0.0, maxCatchUpMs, timeMs - lastTimeMs);
+    lastTimeMs = timeMs;
+
+    // Whole steps only, so tick jitter and dropped frames don't change the
+    // motion. The tolerance stops a tick that lands on a step boundary from
+    // missing it through rounding, which would make the rate matter again.
+    constexpr double toleranceMs = 1.0e-4;
+    accumulatorMs += elapsedMs;
+    int due = (int)((accumulatorMs + toleranceMs) / stepMs);
+
+    if (due == 0)
+        return;
+
+    double firstStepMs = timeMs - accumulatorMs + stepMs;
+
+    for (int i = 0; i < due; ++i)
+        step(firstStepMs + i * stepMs);
+
+    accumulatorMs -= due * stepMs;
+    publish();
+}
+
+void XYSimulation::runSteps(int count)
+{
+    // Not tied to the clock, so everything posted so far is due
+    for (int i = 0; i < count; ++i)
+        step(std::numeric_limits<double>::max());
+
+    publish();
+}
+
+void XYSimulation::publish()
+{
+    auto& snapshot = snapshots.getWriteBuffer();
+
+    for (int layer = 0; layer < numLayers; ++layer)
+    {
+        snapshot.previous[(size_t)layer] = springs.getState(cursor, layer, 0.0f);
+        snapshot.current[(size_t)layer] = springs.getState(cursor, layer);
+    }
+
+    snapshot.stepTimeMs = lastTimeMs - accumulatorMs;
+    snapshot.numSteps = numSteps;
+    snapshot.isDragging = isDragging;
+    snapshot.isSettled = isSettled;
+    snapshot.isBreathing = isBreathing;
+    snapshot.breatheTime = breatheTime;
+    snapshot.breatheBlend = breatheBlend;
+    snapshot.latestInputTimeMs = latestInputTimeMs;
+    snapshot.prediction = predictionStats;
+
+    snapshots.publish();
+}
+
+//==============================================================================
+void XYSimulation::applyInput(double stepTimeMs)
+{
+    // Everything up to this step's time; later samples wait for their step
+    int start1, size1, start2, size2;
+    inputFifo.prepareToRead(inputFifo.getNumReady(), start1, size1, start2, size2);
+
+    int numApplied = 0;
+
+    for (int i = 0; i < size1 + size2; ++i)
+    {
+        auto& input = inputs[(size_t)(i < size1 ? start1 + i : start2 + i - size1)];
+
+        if (input.timeMs > stepTimeMs)
+            break;
+
+        handleInput(input, stepTimeMs);
+        ++numApplied;
+    }
+
+    inputFifo.finishedRead(numApplied);
+}
+
+void XYSimulation::handleInput(const Input& input, double stepTimeMs)
+{
+    // Unstamped input happened as far as anyone knows at this step
+    double timeMs = input.timeMs > 0.0 ? input.timeMs : stepTimeMs;
+
+    if (input.timeMs > 0.0)
+        latestInputTimeMs = input.timeMs;
+
+    switch (input.type)
+    {
+        case Input::press:
+        case Input::drag:
+        case Input::move:
+            // Stop breathing straight away, to prevent jitter
+            isBreathing = false;
+            breatheBlend = 0.0f;
+            idleTimer = 0.0f;
+
+            if (input.type == Input::press)
+            {
+                isDragging = true;
+                predictor = {};
+                numPending = 0;
+            }
+
+            targetX = input.x;
+            targetY = input.y;
+
+            // Automation jumps rather than moves, so there's no velocity to lead by
+            if (input.type != Input::move)
+                addPredictionSample(input.x, input.y, timeMs);
+            break;
+
+        case Input::release:
+            // Don't reset idle timer - let it accumulate naturally
+            // idleTimer will start when velocity drops below threshold
+            isDragging = false;
+            numPending = 0;     // Aimed past the last sample, so never scored
+            break;
+
+        case Input::disperse:
+        {
+            isDispersing = true;
+            disperseTime = 0.0f;
+            isBreathing = false;
+            breatheBlend = 0.0f;
+
+            // Add radial outward velocity to all glow layers
+            // Use golden angle for better distribution
+            const float goldenAngle = 2.39996f; // Golden angle in radians
+
+            for (int i = 1; i < numLayers; ++i)
+            {
+                // Use golden angle spiral for natural, even distribution
+                float angle = input.angle + (i - 1) * goldenAngle;
+                float dx = std::cos(angle);
+                float dy = std::sin(angle);
+
+                // Apply outward impulse - stronger for outer layers
+                float impulse = 0.08f + i * 0.025f;
+                springs.addVelocity(cursor, i, dx * impulse, dy * impulse);
+            }
+            break;
+        }
+    }
+}
+
+void XYSimulation::step(double stepTimeMs)
+{
+    constexpr float dt = springStep;
+    constexpr float stepLengthMs = (float)stepMs;
+
+    if (predictionSettings.acquire())
+        prediction = predictionSettings.getReadBuffer();
+
+    applyInput(stepTimeMs);
+    ++numSteps;
+
+    // Update all spring layers; the trail's tiny velocities decay gradually
+    // so it settles without snapping
+    auto target = getPredictedTarget(stepTimeMs);
+    springs.setTarget(cursor, target.x, target.y);
+    springs.step(dt);
+
+    // Update disperse effect
+    if (isDispersing)
+    {
+        disperseTime += stepLengthMs;
+        if (disperseTime > 500.0f)  // Effect lasts ~500ms
+        {
+            isDispersing = false;
+        }
+    }
+
+    // Check for idle state - use blur layers to determine true stillness
+    float totalVelocity = springs.getLeadMotion(cursor);
+    float blurVelocity = springs.getTrailMotion(cursor);
+
+    isSettled = totalVelocity < 0.001f && blurVelocity < 0.01f && !isDragging && !isDispersing;
+
+    if (isSettled)
+    {
+        idleTimer += stepLengthMs;
+        if (idleTimer > 500.0f)  // Longer delay before breathing starts
+        {
+            if (!isBreathing)
+            {
+                // Start breathing at neutral phase (where sin = 0) to avoid snap
+                breatheTime = 0.0f;
+                breatheBlend = 0.0f;  // Start blend at 0
+                isBreathing = true;
+            }
+        }
+    }
+    else
+    {
+        idleTimer = 0.0f;
+        isBreathing = false;  // Stop breathing when motion detected
+    }
+
+    // Update breathing animation time and blend
+    // Scaled by dt so the speed doesn't depend on the step length
+    if (isBreathing)
+    {
+        breatheTime += 0.025f * dt;
+
+        // Smoothly ramp up breathe blend over ~1 second
+        breatheBlend = juce::jmin(1.0f, breatheBlend + 0.015f * dt);
+    }
+    else
+    {
+        // Quickly fade out breathing when motion starts
+        breatheBlend = juce::jmax(0.0f, breatheBlend - 0.08f * dt);
+    }
+}
+
+//==============================================================================
+void XYSimulation::addPredictionSample(float x, float y, double timeMs)
+{
+    auto& p = predictor;
+    auto dt = (float)(timeMs - p.sampleTimeMs);
+
+    // First sample, or the hand stopped for a while: start from rest
+    if (!p.hasSample || dt > prediction.staleMs)
+    {
+        p = {};
+        p.hasSample = true;
+        p.x = p.sampleX = x;
+        p.y = p.sampleY = y;
+        p.sampleTimeMs = timeMs;
+        numPending = 0;
+        return;
+    }
+
+    // Two samples in the same millisecond say nothing about speed
+    if (dt <= 0.0f)
+    {
+        p.sampleX = x;
+        p.sampleY = y;
+        return;
+    }
+
+    scorePredictions(x, y, timeMs);
+
+    float residualX = x - (p.x + p.vx * dt);
+    float residualY = y - (p.y + p.vy * dt);
+
+    p.x += p.vx * dt + prediction.positionGain * residualX;
+    p.y += p.vy * dt + prediction.positionGain * residualY;
+    p.vx += prediction.velocityGain * residualX / dt;
+    p.vy += prediction.velocityGain * residualY / dt;
+
+    p.sampleX = x;
+    p.sampleY = y;
+    p.sampleTimeMs = timeMs;
+}
+
+void XYSimulation::scorePredictions(float x, float y, double timeMs)
+{
+    auto& p = predictor;
+    int numKept = 0;
+
+    for (int i = 0; i < numPending; ++i)
+    {
+        auto& pending = pendingPredictions[(size_t)i];
+
+        if (pending.timeMs > timeMs)
+        {
+            pendingPredictions[(size_t)numKept++] = pending;
+            continue;
+        }
+
+        // Where the hand was then, between this sample and the one before
+        auto t = (float)juce::jlimit(0.0, 1.0, (pending.timeMs - p.sampleTimeMs) / (timeMs - p.sampleTimeMs));
+        float actualX = p.sampleX + (x - p.sampleX) * t;
+        float actualY = p.sampleY + (y - p.sampleY) * t;
+
+        float error = std::hypot(pending.x - actualX, pending.y - actualY);
+        float errorWithout = std::hypot(pending.lastX - actualX, pending.lastY - actualY);
+
+        auto& stats = predictionStats;
+        ++stats.numScored;
+        errorSum += error;
+        errorSumWithout += errorWithout;
+        stats.meanError = (float)(errorSum / (double)stats.numScored);
+        stats.meanErrorWithout = (float)(errorSumWithout / (double)stats.numScored);
+        stats.maxError = juce::jmax(stats.maxError, error);
+    }
+
+    numPending = numKept;
+}
+
+juce::Point<float> XYSimulation::getPredictedTarget(double stepTimeMs)
+{
+    auto& p = predictor;
+
+    if (!prediction.enabled || !isDragging || !p.hasSample)
+        return { targetX, targetY };
+
+    auto sinceSampleMs = (float)(stepTimeMs - p.sampleTimeMs);
+    float fade = 1.0f - sinceSampleMs / prediction.staleMs;
+    float leadMs = prediction.leadMs > 0.0f ? prediction.leadMs : measuredLatencyMs.load();
+
+    if (fade <= 0.0f || leadMs <= 0.0f)
+        return { targetX, targetY };
+
+    // From the filtered position at the last sample to leadMs past now,
+    // relative to the sample itself
+    float horizon = sinceSampleMs + leadMs;
+    float offsetX = (p.x + p.vx * horizon - p.sampleX) * juce::jmin(1.0f, fade);
+    float offsetY = (p.y + p.vy * horizon - p.sampleY) * juce::jmin(1.0f, fade);
+
+    float length = std::hypot(offsetX, offsetY);
+
+    if (length > prediction.maxLead)
+    {
+        offsetX *= prediction.maxLead / length;
+        offsetY *= prediction.maxLead / length;
+    }
+
+    juce::Point<float> target(juce::jlimit(0.0f, 1.0f, targetX + offsetX),
+                              juce::jlimit(0.0f, 1.0f, targetY + offsetY));
+
+    if (numPending < (int)pendingPredictions.size())
+        pendingPredictions[(size_t)numPending++] = { stepTimeMs + leadMs, target.x, target.y, targetX, targetY };
+
+    return target;
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include "SpringPhysics.h"
+#include "TripleBuffer.h"
+
+// The XY pad's motion - cursor and glow springs, disperse, idle detection and
+// breathing - stepped in fixed steps of stepMs on a thread of its own, so a
+// busy message thread or a slow paint neither stalls it nor gets stalled by
+// it. Mouse input goes in through a wait-free queue and the state comes back
+// out as snapshots through a TripleBuffer; neither side ever locks.
+//
+// When the thread isn't running (the pad is hidden, or rendering offline)
+// the caller can step it with advanceTo() or runSteps() instead. Only one
+// thread may step it at a time.
+class XYSimulation : private juce::Thread
+{
+public:
+    static constexpr int numLayers = 6;     // The cursor, then the five glow layers
+    static constexpr double stepMs = 1000.0 / 240.0;
+    static constexpr float springStep = (float)(stepMs / 16.67);   // stepMs in the 60 Hz frames the springs are tuned in
+
+    // Overdamped, zero bounce. XYModulator runs the same spring on the audio thread.
+    static constexpr SpringPhysics::Parameters cursorSpring { 0.20f, 1.13f, 1.6f };
+
+    struct Input
+    {
+        // move sets the target without a press, for host automation
+        enum Type { press, drag, release, disperse, move };
+
+        Type type;
+        float x = 0.0f;         // New target (0..1) for press, drag and move
+        float y = 0.0f;
+        float angle = 0.0f;     // Direction of the first layer's push, for disperse
+
+        // When it happened (Time::getMillisecondCounterHiRes), or 0 for
+        // whenever the next step is. Must not go backwards.
+        double timeMs = 0.0;
+    };
+
+    // Leads the cursor's target ahead of the hand along its recent velocity,
+    // to make up for the time between a mouse sample and the frame showing
+    // it. The velocity comes from an alpha-beta (fixed-gain Kalman) filter
+    // over the timestamped drag samples, and the lead fades out once they
+    // stop coming.
+    struct Prediction
+    {
+        bool enabled = false;
+        float leadMs = 0.0f;            // 0 for the latency measured with setMeasuredLatency()
+        float positionGain = 0.5f;      // Alpha: how far each sample pulls the estimate
+        float velocityGain = 0.15f;     // Beta: how fast the velocity follows; lower is smoother
+        float staleMs = 40.0f;          // No sample for this long and the lead is gone
+        float maxLead = 0.08f;          // Furthest ahead of the last sample, in pad widths
+    };
+
+    // How far the predicted targets were from where the hand actually got
+    // to, in pad widths, against just using the last sample
+    struct PredictionStats
+    {
+        int64_t numScored = 0;
+        float meanError = 0.0f;
+        float maxError = 0.0f;
+        float meanErrorWithout = 0.0f;
+    };
+
+    struct Snapshot
+    {
+        // Each spring just before and just after the latest step
+        std::array<SpringPhysics::State, numLayers> previous {};
+        std::array<SpringPhysics::State, numLayers> current {};
+        double stepTimeMs = 0.0;    // When the latest step fell due
+        int64_t numSteps = 0;
+
+        bool isDragging = false;
+        bool isSettled = false;
+        bool isBreathing = false;
+        float breatheTime = 0.0f;
+        float breatheBlend = 0.0f;
+
+        double latestInputTimeMs = 0.0;     // Of the newest sample applied, 0 if unstamped
+        PredictionStats prediction;
+
+        // alpha 0 is previous, 1 is current
+        SpringPhysics::State getState(int layer, float alpha) const;
+    };
+
+    XYSimulation();
+    ~XYSimulation() override;
+
+    // Message thread. Applied by the first step due at or after its time, so
+    // a fast mouse's samples land on the steps they belong to rather than
+    // all on the next one.
+    void post(const Input& input);
+
+    // Message thread. Takes the newest snapshot, if there is one since the
+    // last call, and returns whether it did.
+    bool readLatest(Snapshot& snapshot);
+
+    // Message thread. Taken up at the next step.
+    void setPrediction(const Prediction& newPrediction);
+
+    // Message thread. Time from a mouse sample to the frame that shows it.
+    void setMeasuredLatency(float latencyMs) { measuredLatencyMs = latencyMs; }
+
+    // Run on the simulation thread from now on, or stop it and step by hand
+    void setThreadRunning(bool shouldRun);
+    bool isRunningOnThread() const { return isThreadRunning(); }
+
+    // Without the thread: runs every step due up to timeMs
+    // (Time::getMillisecondCounterHiRes), then publishes
+    void advanceTo(double timeMs);
+
+    // Without the thread: runs numSteps whatever the time, then publishes
+    void runSteps(int numSteps);
+
+    // Without the thread: the time advanceTo() last got to, or resets it to
+    // timeMs so a gap isn't simulated
+    double getClockTime() const { return lastTimeMs; }
+    void resetClock(double timeMs) { lastTimeMs = timeMs; }
+
+private:
+    void run() override;
+
+    void applyInput(double stepTimeMs);
+    void handleInput(const Input& input, double stepTimeMs);
+    void addPredictionSample(float x, float y, double timeMs);
+    void scorePredictions(float x, float y, double timeMs);
+    juce::Point<float> getPredictedTarget(double stepTimeMs);
+    void step(double stepTimeMs);
+    void publish();
+    int getWaitMs() const;
+
+    SpringPhysics springs;
+    int cursor = 0;
+
+    juce::AbstractFifo inputFifo { 256 };
+    std::array<Input, 256> inputs;
+
+    TripleBuffer<Snapshot> snapshots;
+    TripleBuffer<Prediction> predictionSettings;
+    std::atomic<float> measuredLatencyMs { 0.0f };
+
+    // Only touched by whichever thread is stepping
+    double lastTimeMs = 0.0;
+    double accumulatorMs = 0.0;             // Time not yet simulated, under one step
+    int64_t numSteps = 0;
+
+    float targetX = 0.5f;
+    float targetY = 0.5f;
+    bool isDragging = false;
+    float idleTimer = 0.0f;
+    bool isBreathing = true;
+    float breatheTime = 0.0f;
+    float breatheBlend = 0.0f;  // Smooth transition into breathing
+    bool isDispersing = false;
+    float disperseTime = 0.0f;
+    bool isSettled = false;
+    double latestInputTimeMs = 0.0;
+
+    // Alpha-beta filter over the drag samples
+    struct Predictor
+    {
+        bool hasSample = false;
+        float sampleX = 0.0f, sampleY = 0.0f;   // Newest, as it came
+        double sampleTimeMs = 0.0;
+        float x = 0.0f, y = 0.0f;               // Filtered
+        float vx = 0.0f, vy = 0.0f;             // Per ms
+    };
+
+    // A target that was aimed at where the hand would be at timeMs, kept
+    // until a sample at or after then says where it really was
+    struct PendingPrediction
+    {
+        double timeMs;
+        float x, y;                 // Predicted
+        float lastX, lastY;         // The last sample, which is what it replaced
+    };
+
+    Prediction prediction;
+    Predictor predictor;
+    std::array<PendingPrediction, 128> pendingPredictions;
+    int numPending = 0;
+    PredictionStats predictionStats;
+    double errorSum = 0.0, errorSumWithout = 0.0;
+
+    // Longest gap one advance will catch up on; beyond it (a stall, a
+    // debugger) time is dropped. Covers the thread's wait for breathing.
+    static constexpr double maxCatchUpMs = 600.0;
+
+    JUCE_DECLARE_NON_COPYABLE(XYSimulation)
+};